@@ -27,13 +27,22 @@ SOURCES += \
     spawnmaster.cpp \
     sceneobject.cpp \
     resourcemaster.cpp \
-    grass.cpp \
-    frop.cpp \
+    vegetation.cpp \
+    fropfield.cpp \
     luckey.cpp \
     world.cpp \
     ekelplitf.cpp \
     volcano.cpp \
-    storm.cpp
+    storm.cpp \
+    occupancygrid.cpp \
+    platformgenerator.cpp \
+    terrainbaker.cpp \
+    propulsion.cpp \
+    shelldynamics.cpp \
+    shellindex.cpp \
+    updatemaster.cpp \
+    audiomaster.cpp \
+    layoutmaster.cpp
 
 HEADERS += \
     mastercontrol.h \
@@ -46,10 +55,23 @@ HEADERS += \
     spawnmaster.h \
     sceneobject.h \
     resourcemaster.h \
-    grass.h \
-    frop.h \
+    vegetation.h \
+    fropfield.h \
     luckey.h \
     world.h \
     ekelplitf.h \
     volcano.h \
-    storm.h
+    storm.h \
+    occupancygrid.h \
+    autotile.h \
+    platformgenerator.h \
+    randomstream.h \
+    terrainbaker.h \
+    massproperties.h \
+    propulsion.h \
+    shelldynamics.h \
+    shellindex.h \
+    updatemaster.h \
+    audiomaster.h \
+    layoutmaster.h \
+    shellcoords.h
@@ -0,0 +1,186 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "mastercontrol.h"
+
+#include "audiomaster.h"
+
+AudioMaster::AudioMaster(Context* context) : Object(context),
+    voices_{},
+    root_{},
+    maxVoices_{AUDIO_MAX_VOICES}
+{
+    SubscribeToEvent(E_SOUNDFINISHED, URHO3D_HANDLER(AudioMaster, HandleSoundFinished));
+    SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(AudioMaster, HandlePostUpdate));
+}
+
+void AudioMaster::SetMaxVoices(unsigned maxVoices)
+{
+    maxVoices_ = Max(maxVoices, 1u);
+
+    while (voices_.Size() > maxVoices_) {
+
+        voices_.Back().source_->Stop();
+        voices_.Back().node_->Remove();
+        voices_.Pop();
+    }
+}
+
+SoundSource3D* AudioMaster::Play(Sound* sample, Node* node, float gain, int priority)
+{
+    if (!sample || !node)
+        return nullptr;
+
+    Voice* voice{ Acquire(node->GetWorldPosition(), priority) };
+    if (!voice)
+        return nullptr;
+
+    voice->target_ = node;
+    voice->node_->SetWorldPosition(node->GetWorldPosition());
+
+    return Start(voice, sample, gain, priority);
+}
+
+SoundSource3D* AudioMaster::Play(Sound* sample, const Vector3& position, float gain, int priority)
+{
+    if (!sample)
+        return nullptr;
+
+    Voice* voice{ Acquire(position, priority) };
+    if (!voice)
+        return nullptr;
+
+    voice->node_->SetWorldPosition(position);
+
+    return Start(voice, sample, gain, priority);
+}
+
+AudioMaster::Voice* AudioMaster::Acquire(const Vector3& position, int priority)
+{
+    //Voices left behind by a removed scene are free as well; that sends no
+    //finished event, so they are released here
+    for (Voice& voice : voices_) {
+
+        if (!voice.source_->IsPlaying() || !voice.source_->IsEnabledEffective() || !voice.node_->GetScene()) {
+
+            voice.source_->Stop();
+            Release(voice);
+            return &voice;
+        }
+    }
+
+    if (voices_.Size() < maxVoices_) {
+
+        Node* voiceNode{ GetRoot()->CreateChild("Voice") };
+        SoundSource3D* source{ voiceNode->CreateComponent<SoundSource3D>() };
+        source->SetSoundType(SOUND_EFFECT);
+
+        voices_.Push(Voice{ SharedPtr<Node>(voiceNode), source, nullptr, 0 });
+        return &voices_.Back();
+    }
+
+    //Steal the least important voice, preferring the farthest
+    SoundListener* listener{ GetSubsystem<Audio>()->GetListener() };
+    const Vector3 listenerPosition{ listener && listener->GetNode() ? listener->GetNode()->GetWorldPosition() : position };
+    Voice* victim{ nullptr };
+    float victimDistance{ 0.0f };
+
+    for (Voice& voice : voices_) {
+
+        const float distance{ (voice.node_->GetWorldPosition() - listenerPosition).LengthSquared() };
+
+        if (!victim || voice.priority_ < victim->priority_
+         || (voice.priority_ == victim->priority_ && distance > victimDistance)) {
+
+            victim = &voice;
+            victimDistance = distance;
+        }
+    }
+
+    //Never drop a more important or nearer sound for this one
+    if (victim->priority_ > priority
+     || (victim->priority_ == priority && victimDistance <= (position - listenerPosition).LengthSquared()))
+        return nullptr;
+
+    //Stopping sends no finished event either
+    victim->source_->Stop();
+    Release(*victim);
+    return victim;
+}
+
+SoundSource3D* AudioMaster::Start(Voice* voice, Sound* sample, float gain, int priority)
+{
+    voice->priority_ = priority;
+    voice->node_->SetEnabled(true);
+    voice->source_->SetGain(gain);
+    voice->source_->Play(sample);
+
+    return voice->source_;
+}
+
+void AudioMaster::Release(Voice& voice)
+{
+    //The root is recreated along with the scene
+    voice.node_->SetParent(GetRoot());
+    voice.node_->SetEnabled(false);
+    voice.target_.Reset();
+}
+
+Node* AudioMaster::GetRoot()
+{
+    if (!root_)
+        root_ = MC->GetScene()->CreateChild("Voices");
+
+    return root_;
+}
+
+void AudioMaster::HandleSoundFinished(StringHash eventType, VariantMap& eventData)
+{ (void)eventType;
+
+    SoundSource* source{ static_cast<SoundSource*>(eventData[SoundFinished::P_SOUNDSOURCE].GetPtr()) };
+
+    for (Voice& voice : voices_) {
+
+        if (voice.source_ == source) {
+
+            Release(voice);
+            return;
+        }
+    }
+}
+
+void AudioMaster::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
+{ (void)eventType; (void)eventData;
+
+    for (Voice& voice : voices_) {
+
+        if (!voice.node_->IsEnabled() || voice.target_.Null())
+            continue;
+
+        //A hidden or removed object takes its sound along; neither sends a finished event
+        if (voice.target_.Expired() || !voice.target_->IsEnabled()) {
+
+            voice.source_->Stop();
+            Release(voice);
+
+        } else {
+
+            voice.node_->SetWorldPosition(voice.target_->GetWorldPosition());
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef AUDIOMASTER_H
+#define AUDIOMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+
+#define AUDIO_MAX_VOICES 32
+
+//Shares a capped pool of 3D sound sources between all objects. Voices stay
+//under a root node of their own and copy the position of the node they follow
+//while their sound plays; they stop when that node is disabled or removed.
+//When all voices are busy, the one with the lowest priority is stolen, and
+//the one farthest from the listener when priorities tie.
+class AudioMaster : public Object
+{
+    URHO3D_OBJECT(AudioMaster, Object);
+public:
+    AudioMaster(Context* context);
+
+    void SetMaxVoices(unsigned maxVoices);
+    unsigned GetMaxVoices() const { return maxVoices_; }
+
+    //Plays a sample following a node; returns null when no voice was free to take
+    SoundSource3D* Play(Sound* sample, Node* node, float gain = 0.3f, int priority = 0);
+    //Plays a sample at a fixed position
+    SoundSource3D* Play(Sound* sample, const Vector3& position, float gain = 0.3f, int priority = 0);
+
+private:
+    struct Voice
+    {
+        SharedPtr<Node> node_;
+        SoundSource3D* source_;
+        WeakPtr<Node> target_;
+        int priority_;
+    };
+
+    Voice* Acquire(const Vector3& position, int priority);
+    SoundSource3D* Start(Voice* voice, Sound* sample, float gain, int priority);
+    void Release(Voice& voice);
+    Node* GetRoot();
+    void HandleSoundFinished(StringHash eventType, VariantMap& eventData);
+    void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
+
+    Vector<Voice> voices_;
+    WeakPtr<Node> root_;
+    unsigned maxVoices_;
+};
+
+#endif // AUDIOMASTER_H
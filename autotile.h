@@ -0,0 +1,149 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef AUTOTILE_H
+#define AUTOTILE_H
+
+#include <Urho3D/Urho3D.h>
+
+#include "platform.h"
+
+struct FringeElement
+{
+    CornerType type_;
+    float rotation_;
+};
+
+struct FringeTile
+{
+    FringeElement elements_[TE_LENGTH];
+};
+
+//Fringe pieces for every combination of the eight neighbours of a tile,
+//indexed by Platform::GetNeighbourMask(coords).
+namespace AutoTile {
+
+struct Table
+{
+    FringeTile tiles_[256];
+};
+
+//The three neighbours an element touches, taken from the full mask
+constexpr unsigned ElementMask(unsigned mask, int element)
+{
+    return element == TE_NORTHEAST ? (mask & 7u)
+         : element == TE_SOUTHEAST ? ((mask >> 2) & 7u)
+         : element == TE_SOUTHWEST ? ((mask >> 4) & 7u)
+                                   : (((mask >> 6) | (mask << 2)) & 7u);
+}
+
+constexpr CornerType ElementType(unsigned elementMask, int element)
+{
+    return elementMask == 0 ? CT_IN
+         : elementMask == 1 ? CT_STRAIGHT
+         : elementMask == 2 ? (element == TE_NORTHEAST || element == TE_SOUTHEAST ? CT_BRIDGE : CT_NONE)
+         : elementMask == 5 ? CT_OUT
+         : elementMask == 7 ? CT_FILL
+                            : CT_NONE;
+}
+
+constexpr float ElementRotation(CornerType type, int element)
+{
+    if (type == CT_BRIDGE)
+        return (element == TE_SOUTHEAST || element == TE_NORTHWEST) ? 90.0f : 0.0f;
+
+    if (type == CT_IN || type == CT_OUT || type == CT_STRAIGHT) {
+        switch (element) {
+        case TE_NORTHEAST: return 180.0f;
+        case TE_SOUTHEAST: return -90.0f;
+        case TE_NORTHWEST: return 90.0f;
+        default: return 0.0f;
+        }
+    }
+
+    return 0.0f;
+}
+
+constexpr Table Build()
+{
+    Table table{};
+
+    for (unsigned mask{0}; mask < 256; ++mask) {
+        for (int e{0}; e < TE_LENGTH; ++e) {
+
+            FringeElement& piece{ table.tiles_[mask].elements_[e] };
+            piece.type_ = ElementType(ElementMask(mask, e), e);
+            piece.rotation_ = ElementRotation(piece.type_, e);
+        }
+    }
+
+    return table;
+}
+
+constexpr Table TABLE{ Build() };
+
+inline const FringeTile& Lookup(unsigned char neighbourMask) { return TABLE.tiles_[neighbourMask]; }
+
+//Corner types and rotations the switch based picking produced, written out per
+//element (in TileElement order) for each combination of the three neighbours it checks
+constexpr Neighbour EXPECTED_NEIGHBOURS[TE_LENGTH][3]{
+    { NB_NORTH, NB_NORTHEAST, NB_EAST  },
+    { NB_EAST,  NB_SOUTHEAST, NB_SOUTH },
+    { NB_WEST,  NB_NORTHWEST, NB_NORTH },
+    { NB_SOUTH, NB_SOUTHWEST, NB_WEST  }
+};
+
+constexpr CornerType EXPECTED_TYPES[TE_LENGTH][8]{
+    { CT_IN, CT_STRAIGHT, CT_BRIDGE, CT_NONE, CT_NONE, CT_OUT, CT_NONE, CT_FILL },
+    { CT_IN, CT_STRAIGHT, CT_BRIDGE, CT_NONE, CT_NONE, CT_OUT, CT_NONE, CT_FILL },
+    { CT_IN, CT_STRAIGHT, CT_NONE,   CT_NONE, CT_NONE, CT_OUT, CT_NONE, CT_FILL },
+    { CT_IN, CT_STRAIGHT, CT_NONE,   CT_NONE, CT_NONE, CT_OUT, CT_NONE, CT_FILL }
+};
+
+constexpr float EXPECTED_ROTATIONS[TE_LENGTH][8]{
+    { 180.0f, 180.0f,  0.0f, 0.0f, 0.0f, 180.0f, 0.0f, 0.0f },
+    { -90.0f, -90.0f, 90.0f, 0.0f, 0.0f, -90.0f, 0.0f, 0.0f },
+    {  90.0f,  90.0f,  0.0f, 0.0f, 0.0f,  90.0f, 0.0f, 0.0f },
+    {   0.0f,   0.0f,  0.0f, 0.0f, 0.0f,   0.0f, 0.0f, 0.0f }
+};
+
+constexpr bool MatchesExpected()
+{
+    for (unsigned mask{0}; mask < 256; ++mask) {
+        for (int e{0}; e < TE_LENGTH; ++e) {
+
+            unsigned elementMask{ 0 };
+
+            for (int i{0}; i < 3; ++i)
+                elementMask |= ((mask >> EXPECTED_NEIGHBOURS[e][i]) & 1u) << i;
+
+            const FringeElement& piece{ TABLE.tiles_[mask].elements_[e] };
+
+            if (piece.type_ != EXPECTED_TYPES[e][elementMask]
+             || piece.rotation_ != EXPECTED_ROTATIONS[e][elementMask])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static_assert(MatchesExpected(), "Autotile table differs from the expected corner pieces");
+}
+
+#endif // AUTOTILE_H
@@ -16,6 +16,8 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+#include "randomstream.h"
+
 #include "ekelplitf.h"
 
 void Ekelplitf::RegisterObject(Context *context)
@@ -36,6 +38,7 @@ void Ekelplitf::OnNodeSet(Node *node)
 //    bodyModel_->SetModel(RESOURCE->GetModel("Ekelplithf_LOD023"));
     bodyModel_->SetMaterial(RESOURCE->GetMaterial("Kekelplithf"));
     bodyModel_->SetCastShadows(true);
+    bodyModel_->SetViewMask(VM_SCENERY);
 /*
     for (int e{0}; e < 3; ++e) {
 
@@ -58,20 +61,26 @@ void Ekelplitf::OnNodeSet(Node *node)
 //    animCtrl->PlayExclusive("Resources/Animations/StandUp.ani", 0, true);
 //    animCtrl->SetSpeed("Resources/Animations/StandUp.ani", 0.5f + randomizer_);
 
-//    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(Ekelplitf, HandleUpdate));
 }
 
-void Ekelplitf::Set(Vector3 position, Node *parent)
+void Ekelplitf::Set(Vector3 position, Node *parent, RandomStream& random)
 {
     node_->SetParent(parent);
     node_->SetRotation(Quaternion::IDENTITY);
 
     SceneObject::Set(position);
 
-    randomizer_ = Random(0.5f,0.75f);
-    node_->Rotate(Quaternion(0.0f,Random(360.0f),0.0f));
-    node_->SetScale(Random(0.015f,0.016f));
+    randomizer_ = random.Random(0.5f,0.75f);
+    node_->Rotate(Quaternion(0.0f,random.Random(360.0f),0.0f));
+    node_->SetScale(random.Random(0.015f,0.016f));
+
+}
 
+void Ekelplitf::Disable()
+{
+    //Leave the tile, which may be handed to another occupant
+    node_->SetParent(GetScene());
+    SceneObject::Disable();
 }
 
 void Ekelplitf::Start()
@@ -81,7 +90,3 @@ void Ekelplitf::Stop()
 {
 }
 
-void Ekelplitf::HandleUpdate(StringHash eventType, VariantMap &eventData)
-{
-//    double timeStep = eventData[Update::P_TIMESTEP].GetFloat();
-}
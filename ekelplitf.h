@@ -32,6 +32,8 @@ class Sprite;
 
 using namespace Urho3D;
 
+class RandomStream;
+
 class Ekelplitf : public SceneObject
 {
     URHO3D_OBJECT(Ekelplitf, SceneObject);
@@ -39,12 +41,12 @@ public:
     Ekelplitf(Context *context);
     static void RegisterObject(Context* context);
     virtual void OnNodeSet(Node* node);
-    virtual void Set(Vector3 position, Node* parent);
+    virtual void Set(Vector3 position, Node* parent, RandomStream& random);
+    void Disable() override;
 
     virtual void Start();
     virtual void Stop();
 private:
-    void HandleUpdate(StringHash eventType, VariantMap& eventData);
     AnimatedModel* bodyModel_;
     Vector<AnimatedModel*> equipment_;
     float randomizer_;
@@ -0,0 +1,235 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
+#include "resourcemaster.h"
+#include "randomstream.h"
+#include "updatemaster.h"
+#include "mastercontrol.h"
+#include "vegetation.h"
+
+#include "fropfield.h"
+
+void FropField::RegisterObject(Context* context)
+{
+    context->RegisterFactory<FropField>();
+}
+
+FropField::FropField(Context* context) : Component(context),
+    vegetation_{},
+    time_{0.0f},
+    numGrowing_{0},
+    registered_{false},
+    placements_{},
+    coords_{},
+    start_{},
+    targetX_{},
+    targetY_{},
+    targetZ_{},
+    scaleX_{},
+    scaleY_{},
+    scaleZ_{}
+{
+}
+
+FropField::~FropField()
+{
+    SetRegistered(false);
+}
+
+void FropField::OnNodeSet(Node* node)
+{ if (!node) return;
+
+    vegetation_ = node_->CreateComponent<Vegetation>();
+    vegetation_->SetModel(CACHE->GetResource<Model>("Resources/Models/Frop.mdl"));
+    vegetation_->SetMaterial(CACHE->GetResource<Material>("Resources/Materials/Frop.xml"));
+    vegetation_->SetCastShadows(true);
+    vegetation_->SetViewMask(VM_SCENERY);
+}
+
+void FropField::Plant(const Vector3& position, Node* tile, const IntVector2& coords, RandomStream& random)
+{
+    const float growthStart{ random.Random(0.0f, 23.0f) };
+    const Quaternion rotation{ random.Random(-10.0f, 10.0f), random.Random(360.0f), random.Random(-10.0f, 10.0f) };
+    const float randomWidth{ random.Random(0.5f, 1.0f) };
+    const float height{ random.Random(0.5f, 0.5f + randomWidth) };
+
+    //Relative to the platform, which carries the vegetation
+    const Matrix3x4 placement{ node_->GetWorldTransform().Inverse() * tile->GetWorldTransform()
+                             * Matrix3x4(position, rotation, Vector3::ONE) };
+    vegetation_->AddInstance(placement.Scaled(Vector3::ZERO));
+
+    placements_.Push(placement);
+    coords_.Push(coords);
+    start_.Push(time_ + growthStart);
+    targetX_.Push(randomWidth);
+    targetY_.Push(height);
+    targetZ_.Push(randomWidth);
+    scaleX_.Push(0.0f);
+    scaleY_.Push(0.0f);
+    scaleZ_.Push(0.0f);
+
+    //Move it into the growing range
+    Swap(numGrowing_++, placements_.Size() - 1);
+    SetRegistered(true);
+}
+
+void FropField::Uproot(const IntVector2& coords)
+{
+    for (unsigned f{placements_.Size()}; f-- > 0; ) {
+
+        if (coords_[f] != coords)
+            continue;
+
+        Erase(f);
+    }
+
+    if (!numGrowing_)
+        SetRegistered(false);
+}
+
+void FropField::UpdateAll(FropField** fields, unsigned count, float timeStep)
+{
+    for (unsigned f{0}; f < count; ++f)
+        fields[f]->Grow(timeStep);
+}
+
+void FropField::Grow(float timeStep)
+{
+    time_ += timeStep;
+
+    const float rate{ Min(FROP_GROWTH_RATE * timeStep, 1.0f) };
+    unsigned f{0};
+
+#ifdef URHO3D_SSE
+    //Four frops at a time; those yet to start get a step of zero
+    const __m128 now{ _mm_set1_ps(time_) };
+    const __m128 rates{ _mm_set1_ps(rate) };
+
+    for (; f + 4 <= numGrowing_; f += 4) {
+
+        const __m128 step{ _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(&start_[f]), now), rates) };
+        float* scales[3]{ &scaleX_[f], &scaleY_[f], &scaleZ_[f] };
+        const float* targets[3]{ &targetX_[f], &targetY_[f], &targetZ_[f] };
+
+        for (int a{0}; a < 3; ++a) {
+
+            const __m128 scale{ _mm_loadu_ps(scales[a]) };
+            const __m128 target{ _mm_loadu_ps(targets[a]) };
+            _mm_storeu_ps(scales[a], _mm_add_ps(scale, _mm_mul_ps(step, _mm_sub_ps(target, scale))));
+        }
+    }
+#endif
+
+    for (; f < numGrowing_; ++f) {
+
+        if (start_[f] >= time_)
+            continue;
+
+        scaleX_[f] += rate * (targetX_[f] - scaleX_[f]);
+        scaleY_[f] += rate * (targetY_[f] - scaleY_[f]);
+        scaleZ_[f] += rate * (targetZ_[f] - scaleZ_[f]);
+    }
+
+    //Push the new scales to the instances, retiring grown frops.
+    //Walking backwards leaves swapped in frops already handled.
+    for (unsigned g{numGrowing_}; g-- > 0; ) {
+
+        if (start_[g] >= time_)
+            continue;
+
+        const float remaining{ Max(Max(Abs(targetX_[g] - scaleX_[g]),
+                                       Abs(targetY_[g] - scaleY_[g])),
+                                       Abs(targetZ_[g] - scaleZ_[g])) };
+
+        if (remaining < FROP_SNAP) {
+
+            scaleX_[g] = targetX_[g];
+            scaleY_[g] = targetY_[g];
+            scaleZ_[g] = targetZ_[g];
+            vegetation_->SetInstance(g, placements_[g].Scaled(Vector3(targetX_[g], targetY_[g], targetZ_[g])));
+            Swap(g, --numGrowing_);
+
+        } else {
+
+            vegetation_->SetInstance(g, placements_[g].Scaled(Vector3(scaleX_[g], scaleY_[g], scaleZ_[g])));
+        }
+    }
+
+    if (!numGrowing_)
+        SetRegistered(false);
+}
+
+void FropField::SetRegistered(bool registered)
+{
+    if (registered == registered_)
+        return;
+
+    if (UpdateMaster* updateMaster{ GetSubsystem<UpdateMaster>() }) {
+
+        if (registered)
+            updateMaster->Register(this);
+        else
+            updateMaster->Unregister(this);
+    }
+
+    registered_ = registered;
+}
+
+void FropField::Swap(unsigned a, unsigned b)
+{
+    if (a == b)
+        return;
+
+    vegetation_->SwapInstances(a, b);
+    Urho3D::Swap(placements_[a], placements_[b]);
+    Urho3D::Swap(coords_[a], coords_[b]);
+    Urho3D::Swap(start_[a], start_[b]);
+    Urho3D::Swap(targetX_[a], targetX_[b]);
+    Urho3D::Swap(targetY_[a], targetY_[b]);
+    Urho3D::Swap(targetZ_[a], targetZ_[b]);
+    Urho3D::Swap(scaleX_[a], scaleX_[b]);
+    Urho3D::Swap(scaleY_[a], scaleY_[b]);
+    Urho3D::Swap(scaleZ_[a], scaleZ_[b]);
+}
+
+void FropField::Erase(unsigned index)
+{
+    //Keep growing frops in front
+    if (index < numGrowing_) {
+
+        Swap(index, --numGrowing_);
+        index = numGrowing_;
+    }
+
+    Swap(index, placements_.Size() - 1);
+
+    vegetation_->RemoveLastInstance();
+    placements_.Pop();
+    coords_.Pop();
+    start_.Pop();
+    targetX_.Pop();
+    targetY_.Pop();
+    targetZ_.Pop();
+    scaleX_.Pop();
+    scaleY_.Pop();
+    scaleZ_.Pop();
+}
@@ -0,0 +1,79 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef FROPFIELD_H
+#define FROPFIELD_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+
+//Frops closer than this to their full size on every axis stop growing
+#define FROP_SNAP 0.001f
+#define FROP_GROWTH_RATE 5.0f
+
+class RandomStream;
+class Vegetation;
+
+//All frop crops of one platform. Their growth state is kept in arrays per
+//field with growing frops first, so a step runs over contiguous floats and
+//fully grown frops drop out of it. The frops are drawn as vegetation
+//instances kept in the same order.
+class FropField : public Component
+{
+    URHO3D_OBJECT(FropField, Component);
+public:
+    FropField(Context* context);
+    ~FropField();
+    static void RegisterObject(Context* context);
+
+    //Plants a frop on a tile, to start growing after a random delay
+    void Plant(const Vector3& position, Node* tile, const IntVector2& coords, RandomStream& random);
+    //Removes the frops of a tile
+    void Uproot(const IntVector2& coords);
+    unsigned GetNumFrops() const { return start_.Size(); }
+    unsigned GetNumGrowing() const { return numGrowing_; }
+
+    static void UpdateAll(FropField** fields, unsigned count, float timeStep);
+
+protected:
+    void OnNodeSet(Node* node) override;
+
+private:
+    void Grow(float timeStep);
+    void SetRegistered(bool registered);
+    void Swap(unsigned a, unsigned b);
+    void Erase(unsigned index);
+
+    Vegetation* vegetation_;
+    float time_;
+    unsigned numGrowing_;
+    bool registered_;
+
+    //Per frop; placement on the platform without scale
+    PODVector<Matrix3x4> placements_;
+    PODVector<IntVector2> coords_;
+    PODVector<float> start_;
+    PODVector<float> targetX_;
+    PODVector<float> targetY_;
+    PODVector<float> targetZ_;
+    PODVector<float> scaleX_;
+    PODVector<float> scaleY_;
+    PODVector<float> scaleZ_;
+};
+
+#endif // FROPFIELD_H
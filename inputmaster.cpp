@@ -19,7 +19,7 @@
 #include "inputmaster.h"
 #include "platform.h"
 #include "oneirocam.h"
-#include "slot.h"
+#include "propulsion.h"
 
 InputMaster::InputMaster(Context* context) : Object(context)
 {
@@ -28,68 +28,66 @@ InputMaster::InputMaster(Context* context) : Object(context)
     SubscribeToEvent(E_MOUSEBUTTONDOWN, URHO3D_HANDLER(InputMaster, HandleMouseDown));
     //Subscribe key down event.
     SubscribeToEvent(E_KEYDOWN, URHO3D_HANDLER(InputMaster, HandleKeyDown));
+    SubscribeToEvent(E_KEYUP, URHO3D_HANDLER(InputMaster, HandleKeyUp));
+    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(InputMaster, HandleUpdate));
+}
+
+void InputMaster::HandleUpdate(StringHash eventType, VariantMap &eventData)
+{
+    //Only selected platforms show their slots
+    const Vector3 cursor{ MC->world.cursor.sceneCursor->GetWorldPosition() };
+
+    for (Platform* platform : selectedPlatforms_)
+        platform->UpdateSlotScales(cursor);
 }
 
 void InputMaster::HandleMouseDown(StringHash eventType, VariantMap &eventData)
 {
     int button{ eventData[MouseButtonDown::P_BUTTON].GetInt() };
     if (button == MOUSEB_LEFT) {
-        //See through cursor
-        int first{0};
-        if (MC->world.cursor.hitResults[first].node_->GetNameHash() == N_CURSOR)
-            first = 1;
-
-        if (firstHit_ = SharedPtr<Node>(MC->world.cursor.hitResults[first].node_)) {
-
-            //Platform selection
-            if (firstHit_->HasTag("Platform")) {
-
-                Slot* slot{ firstHit_->GetComponent<Slot>() };
-                //Building interaction, if platform was already selected
-                //Slot interaction, if Former was selected
-                if (slot && selectedPlatforms_.Contains(slot->GetPlatform()))
-                {
-                    SharedPtr<Platform> platform{ firstHit_->GetParentComponent<Platform>(true) };
-                    IntVector2 coords{ IntVector2(firstHit_->GetComponent<Slot>()->coords_) };
-
-                    if (platform->CheckEmpty(coords, true)) {
-                        //Add tile
-                        platform->AddTile(coords);
-                        platform->FixFringe(/*coords*/);
-                        platform->AddMissingSlots();
-                    }
-                    else {
-                        //Add engine row
-                        while (!platform->CheckEmpty(coords, true)){
-                            platform->SetBuilding(coords, B_ENGINE);
-                            coords += IntVector2(0, -1);
-                        }
-                    }
-                } else if (input_->GetKeyDown(KEY_LSHIFT)||input_->GetKeyDown(KEY_RSHIFT)) {
-                    //Add or remove platform to selection when either of the shift keys is held down
-                    SharedPtr<Platform> platform{ firstHit_->GetParentComponent<Platform>(true) };
-
-                    if (platform->IsSelected()) {
-                        platform->SetSelected(false);
-                        selectedPlatforms_.Remove(platform);
-                    } else {
-                        platform->SetSelected(true);
-                        selectedPlatforms_ += platform;
+        PlatformPick pick{};
+
+        //Platform selection
+        if (PickPlatform(pick)) {
+
+            Platform* platform{ pick.platform_ };
+            //Building interaction, if platform was already selected
+            //Slots grow tiles and tiles grow engine rows
+            if (selectedPlatforms_.Contains(platform))
+            {
+                IntVector2 coords{ pick.coords_ };
+
+                if (platform->CheckEmpty(coords, true)) {
+                    //Add tile
+                    platform->BuildTile(coords);
+                    platform->CommitEdits();
+                }
+                else {
+                    //Add engine row
+                    while (!platform->CheckEmpty(coords, true)){
+                        platform->SetBuilding(coords, B_ENGINE);
+                        coords += IntVector2(0, -1);
                     }
-
+                }
+            } else if (input_->GetKeyDown(KEY_LSHIFT)||input_->GetKeyDown(KEY_RSHIFT)) {
+                //Add or remove platform to selection when either of the shift keys is held down
+                if (platform->IsSelected()) {
+                    platform->SetSelected(false);
+                    selectedPlatforms_.Remove(platform);
                 } else {
-                //Select single platform
-                    SharedPtr<Platform> platform{ firstHit_->GetParentComponent<Platform>(true) };
-                    if (platform)
-                        SetSelection(platform);
+                    platform->SetSelected(true);
+                    selectedPlatforms_ += platform;
                 }
 
+            } else {
+            //Select single platform
+                SetSelection(platform);
             }
 
-            //Void interaction (create new platform)
-            else {
-                SPAWN->Create<Platform>()->Set(MC->world.cursor.sceneCursor->GetPosition());
-            }
+        }
+        //Void interaction (create new platform)
+        else if (MC->world.cursor.hitDistance != M_INFINITY) {
+            SPAWN->Create<Platform>()->Set(MC->world.cursor.sceneCursor->GetPosition());
         }
     }
     else if (button == MOUSEB_RIGHT){
@@ -134,20 +132,44 @@ void InputMaster::HandleKeyDown(StringHash eventType, VariantMap &eventData)
         Log::Write(1, fileName);
         screenshot.SavePNG(fileName);
     }
+    else if (key == KEY_UP || key == KEY_DOWN)
+        UpdateThrottle();
     else if (key == KEY_L)
     {
-        Platform* platform{};
-        if (firstHit_->GetNameHash() == N_TILEPART) platform = MC->platformMap_[firstHit_->GetParent()->GetParent()->GetID()];
-        else if (firstHit_->GetNameHash() == N_SLOT) platform = MC->platformMap_[firstHit_->GetParent()->GetID()];
-        if (platform) MC->world.camera->Lock(platform);
+        PlatformPick pick{};
+        if (PickPlatform(pick)) MC->world.camera->Lock(pick.platform_);
     }
 }
 
+void InputMaster::HandleKeyUp(StringHash eventType, VariantMap &eventData)
+{
+    int key{ eventData[KeyUp::P_KEY].GetInt() };
+
+    if (key == KEY_UP || key == KEY_DOWN)
+        UpdateThrottle();
+}
+
+void InputMaster::UpdateThrottle()
+{
+    //Arrow keys drive the engines of the selected platforms
+    const float throttle{ static_cast<float>(input_->GetKeyDown(KEY_UP)) - input_->GetKeyDown(KEY_DOWN) };
+
+    for (Platform* platform : selectedPlatforms_)
+        platform->GetPropulsion()->SetThrottle(throttle);
+}
+
+bool InputMaster::PickPlatform(PlatformPick& pick) const
+{
+    //Not past the bubble, since platforms behind it are on the far side of the world
+    return MC->CursorPick(Min(MC->world.cursor.hitDistance + 1.0f, 5.0f * WORLD_RADIUS), pick);
+}
+
 void InputMaster::DeselectAll()
 {
     for (unsigned i{ 0 }; i < selectedPlatforms_.Size(); i++)
     {
         selectedPlatforms_[i]->Deselect();
+        selectedPlatforms_[i]->GetPropulsion()->SetThrottle(0.0f);
     }
     selectedPlatforms_.Clear();
 }
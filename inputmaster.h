@@ -37,7 +37,6 @@ class InputMaster : public Object
     URHO3D_OBJECT(InputMaster, Object);
 public:
     InputMaster(Context* context);
-    WeakPtr<Node> firstHit_;
 
     void DeselectAll();
 private:
@@ -45,9 +44,13 @@ private:
     void HandleMouseDown(StringHash eventType, VariantMap &eventData);
     void HandleKeyDown(StringHash eventType, VariantMap &eventData);
     void HandleMouseUp(StringHash eventType, VariantMap &eventData);
+    void HandleKeyUp(StringHash eventType, VariantMap &eventData);
+    void HandleUpdate(StringHash eventType, VariantMap &eventData);
+    void UpdateThrottle();
 
     Vector<Platform*> selectedPlatforms_;
     void SetSelection(Platform* platform);
+    bool PickPlatform(PlatformPick& pick) const;
 };
 
 #endif // INPUTMASTER_H
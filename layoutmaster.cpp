@@ -0,0 +1,103 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "platform.h"
+#include "platformgenerator.h"
+
+#include "layoutmaster.h"
+
+LayoutMaster::LayoutMaster(Context* context) : Object(context),
+    pending_{}
+{
+    SubscribeToEvent(E_WORKITEMCOMPLETED, URHO3D_HANDLER(LayoutMaster, HandleWorkItemCompleted));
+}
+
+LayoutMaster::~LayoutMaster()
+{
+    //Workers may still be writing to the layouts
+    if (!pending_.Empty()) {
+
+        if (WorkQueue* queue{ GetSubsystem<WorkQueue>() })
+            queue->Complete(0);
+    }
+
+    for (PendingLayout& pending : pending_.Values())
+        delete pending.layout_;
+}
+
+WorkItem* LayoutMaster::Request(Platform* platform, unsigned seed)
+{
+    PlatformLayout* layout{ new PlatformLayout{} };
+    layout->seed_ = seed;
+
+    //Low priority keeps the main thread from waiting on it when completing urgent work
+    WorkQueue* queue{ GetSubsystem<WorkQueue>() };
+    SharedPtr<WorkItem> item{ queue->GetFreeItem() };
+    item->workFunction_ = GenerateLayout;
+    item->aux_ = layout;
+    item->priority_ = 0;
+    item->sendEvent_ = true;
+
+    pending_[item.Get()] = PendingLayout{ WeakPtr<Platform>(platform), layout };
+    queue->AddWorkItem(item);
+
+    return item;
+}
+
+void LayoutMaster::Cancel(WorkItem* item)
+{
+    HashMap<WorkItem*, PendingLayout>::Iterator p{ pending_.Find(item) };
+    if (p == pending_.End())
+        return;
+
+    if (GetSubsystem<WorkQueue>()->RemoveWorkItem(SharedPtr<WorkItem>(item))) {
+
+        delete p->second_.layout_;
+        pending_.Erase(p);
+
+    } else {
+
+        p->second_.platform_.Reset();
+    }
+}
+
+void LayoutMaster::GenerateLayout(const WorkItem* item, unsigned threadIndex)
+{ (void)threadIndex;
+
+    PlatformLayout& layout{ *static_cast<PlatformLayout*>(item->aux_) };
+    bool symmetrical{ true };
+    PlatformGenerator generator{ layout.seed_, symmetrical };
+    generator.Generate(generator.RollSize(), layout);
+    generator.Decorate(layout);
+}
+
+void LayoutMaster::HandleWorkItemCompleted(StringHash eventType, VariantMap& eventData)
+{ (void)eventType;
+
+    HashMap<WorkItem*, PendingLayout>::Iterator p{ pending_.Find(static_cast<WorkItem*>(eventData[WorkItemCompleted::P_ITEM].GetPtr())) };
+    if (p == pending_.End())
+        return;
+
+    const PendingLayout pending{ p->second_ };
+    pending_.Erase(p);
+
+    if (Platform* platform{ pending.platform_ })
+        platform->BuildLayout(*pending.layout_);
+
+    delete pending.layout_;
+}
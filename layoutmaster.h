@@ -0,0 +1,55 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef LAYOUTMASTER_H
+#define LAYOUTMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+
+class Platform;
+struct PlatformLayout;
+
+//Generates platform layouts on worker threads and hands each one to its
+//platform when done. Layouts are owned here rather than by the platform,
+//so a platform can be removed or recycled without waiting on a worker.
+class LayoutMaster : public Object
+{
+    URHO3D_OBJECT(LayoutMaster, Object);
+public:
+    LayoutMaster(Context* context);
+    ~LayoutMaster();
+
+    WorkItem* Request(Platform* platform, unsigned seed);
+    //A layout that is already being generated is dropped once it completes
+    void Cancel(WorkItem* item);
+
+private:
+    struct PendingLayout
+    {
+        WeakPtr<Platform> platform_;
+        PlatformLayout* layout_;
+    };
+
+    static void GenerateLayout(const WorkItem* item, unsigned threadIndex);
+    void HandleWorkItemCompleted(StringHash eventType, VariantMap& eventData);
+
+    HashMap<WorkItem*, PendingLayout> pending_;
+};
+
+#endif // LAYOUTMASTER_H
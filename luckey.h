@@ -28,6 +28,8 @@
 #include <Urho3D/Container/HashMap.h>
 #include <Urho3D/Container/Vector.h>
 #include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
 #include <Urho3D/Engine/Application.h>
 #include <Urho3D/Engine/Console.h>
 #include <Urho3D/Engine/DebugHud.h>
@@ -60,6 +62,7 @@
 #include <Urho3D/Graphics/Zone.h>
 #include <Urho3D/Input/InputEvents.h>
 #include <Urho3D/Input/Input.h>
+#include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
 #include <Urho3D/IO/Log.h>
 #include <Urho3D/IO/MemoryBuffer.h>
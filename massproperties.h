@@ -0,0 +1,70 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef MASSPROPERTIES_H
+#define MASSPROPERTIES_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+
+//Running sums of mass and its first and second moments. Adding or removing
+//a body is O(1) and the center of mass and inertia follow from the sums.
+class MassProperties
+{
+public:
+    MassProperties() { Clear(); }
+
+    //Negative mass removes a previously added body
+    void Add(const Vector3& position, float mass, const Vector3& localInertia = Vector3::ZERO)
+    {
+        mass_ += mass;
+        firstMoment_ += position * mass;
+        squares_ += Vector3(position.x_ * position.x_,
+                            position.y_ * position.y_,
+                            position.z_ * position.z_) * mass;
+        localInertia_ += localInertia;
+    }
+
+    float GetMass() const { return mass_; }
+    Vector3 GetCenter() const { return mass_ > M_EPSILON ? firstMoment_ / mass_ : Vector3::ZERO; }
+
+    //Principal moments about the axes through a point, products of inertia left out
+    Vector3 GetInertia(const Vector3& about) const
+    {
+        //Sum of m * (p - c)^2 per axis
+        const Vector3 spread{ squares_ - 2.0f * about * firstMoment_ + about * about * mass_ };
+
+        return localInertia_ + Vector3(spread.y_ + spread.z_,
+                                       spread.x_ + spread.z_,
+                                       spread.x_ + spread.y_);
+    }
+
+    void Clear()
+    {
+        mass_ = 0.0f;
+        firstMoment_ = squares_ = localInertia_ = Vector3::ZERO;
+    }
+
+private:
+    float mass_;
+    Vector3 firstMoment_;
+    Vector3 squares_;
+    Vector3 localInertia_;
+};
+
+#endif // MASSPROPERTIES_H
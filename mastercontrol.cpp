@@ -21,15 +21,21 @@
 #include "storm.h"
 #include "oneirocam.h"
 #include "platform.h"
+#include "propulsion.h"
+#include "shelldynamics.h"
+#include "shellindex.h"
 #include "tile.h"
 #include "slot.h"
-#include "frop.h"
-#include "grass.h"
+#include "fropfield.h"
+#include "vegetation.h"
 #include "ekelplitf.h"
 
 #include "inputmaster.h"
 #include "resourcemaster.h"
 #include "spawnmaster.h"
+#include "updatemaster.h"
+#include "audiomaster.h"
+#include "layoutmaster.h"
 
 #include "mastercontrol.h"
 
@@ -45,14 +51,28 @@ MasterControl* MasterControl::GetInstance()
 MasterControl::MasterControl(Context *context):
     Application(context),
     platformMap_{},
-    paused_{false}
+    paused_{false},
+    worldSeed_{}
 {
     instance_ = this;
 }
 
 void MasterControl::Setup()
 {
-    SetRandomSeed(GetSubsystem<Time>()->GetSystemTime());
+    //Use -seed <number> to reproduce a world
+    worldSeed_ = GetSubsystem<Time>()->GetSystemTime();
+    const Vector<String>& arguments{ GetArguments() };
+    for (unsigned a{0}; a < arguments.Size(); ++a) {
+
+        const String argument{ arguments[a].ToLower() };
+
+        if (argument == "-seed" && a + 1 < arguments.Size())
+            worldSeed_ = ToUInt(arguments[++a]);
+        //Merge platform terrain into one mesh each
+        else if (argument == "-bake")
+            Platform::bakeTerrain_ = true;
+    }
+    SetRandomSeed(worldSeed_);
     // Modify engine startup parameters.
     //Set custom window title and icon.
     engineParameters_[EP_WINDOW_TITLE] = "Masters of Oneiron";
@@ -74,13 +94,19 @@ void MasterControl::Start()
     Ekelplitf::RegisterObject(context_);
     Tile::RegisterObject(context_);
     Slot::RegisterObject(context_);
-    Frop::RegisterObject(context_);
-    Grass::RegisterObject(context_);
+    FropField::RegisterObject(context_);
+    Vegetation::RegisterObject(context_);
     Platform::RegisterObject(context_);
+    Propulsion::RegisterObject(context_);
+    ShellDynamics::RegisterObject(context_);
+    ShellIndex::RegisterObject(context_);
 
     context_->RegisterSubsystem(this);
     context_->RegisterSubsystem(new InputMaster(context_));
     context_->RegisterSubsystem(new SpawnMaster(context_));
+    context_->RegisterSubsystem(new UpdateMaster(context_));
+    context_->RegisterSubsystem(new AudioMaster(context_));
+    context_->RegisterSubsystem(new LayoutMaster(context_));
     context_->RegisterSubsystem(new ResourceMaster(context_));
 
     // Get default style
@@ -89,6 +115,7 @@ void MasterControl::Start()
     //Create console and debug HUD.
     CreateConsoleAndDebugHud();
     //Create the scene content
+    Log::Write(LOG_INFO, "World seed: " + String(worldSeed_));
     CreateScene();
     //Create the UI content
     CreateUI();
@@ -178,7 +205,10 @@ void MasterControl::CreateScene()
     //Create octree, use default volume (-1000, -1000, -1000) to (1000,1000,1000)
     world.scene->CreateComponent<Octree>();
 
+    //Before the world, so it updates ahead of the platforms' first queries
+    world.scene->CreateComponent<ShellIndex>();
     World* world2 = world.scene->CreateComponent<World>();
+    world.scene->CreateComponent<ShellDynamics>();
 //    World* world2{ SPAWN->Create<World>() };
 
     PhysicsWorld* physicsWorld{ world.scene->CreateComponent<PhysicsWorld>()};
@@ -190,9 +220,11 @@ void MasterControl::CreateScene()
     //Create cursor
     world.cursor.sceneCursor = world.scene->CreateChild("Cursor");
     world.cursor.sceneCursor->SetPosition(Vector3(0.0f,0.0f,0.0f));
+    world.cursor.hitDistance = M_INFINITY;
     StaticModel* cursorObject{world.cursor.sceneCursor->CreateComponent<StaticModel>()};
     cursorObject->SetModel(CACHE->GetResource<Model>("Resources/Models/Kekelplithf.mdl"));
     cursorObject->SetMaterial(CACHE->GetResource<Material>("Resources/Materials/Glow.xml"));
+    cursorObject->SetViewMask(VM_SCENERY);
 
     //Create an Invisible plane for mouse raycasting
 //    world.voidNode = world.scene->CreateChild("Void");
@@ -219,6 +251,7 @@ void MasterControl::CreateScene()
     StaticModel* sunModel{ world.sunNode->CreateComponent<StaticModel>() };
     sunModel->SetModel(RESOURCE->GetModel("Core"));
     sunModel->SetMaterial(RESOURCE->GetMaterial("Core"));
+    sunModel->SetViewMask(VM_SCENERY);
 
     Light* sunLight{world.sunNode->CreateComponent<Light>()};
     sunLight->SetLightType(LIGHT_POINT);
@@ -261,6 +294,10 @@ void MasterControl::CreateScene()
     for (Vector3 v : world2->GetRhombicCenters()) {
         SPAWN->Create<Platform>()->Set(v);
     }
+
+    //Fill the pools in the background so new platforms spawn without a hitch
+    SPAWN->Prewarm<Tile>(5000);
+    SPAWN->Prewarm<Slot>(5000);
 }
 
 void MasterControl::HandleUpdate(StringHash eventType, VariantMap &eventData)
@@ -280,27 +317,24 @@ void MasterControl::UpdateCursor(float timeStep)
 {
     world.cursor.sceneCursor->Rotate(Quaternion(0.0f, 100.0f * timeStep, 0.0f));
     world.cursor.sceneCursor->SetScale((world.cursor.sceneCursor->GetWorldPosition() - world.camera->GetWorldPosition()).Length() * 0.0023f);
-    if (CursorRayCast(5.0f * WORLD_RADIUS, world.cursor.hitResults)) {
-        for (int i{0}; i < world.cursor.hitResults.Size(); ++i) {
-            if (world.cursor.hitResults[i].node_->HasTag("Bubble")) {
-                world.cursor.sceneCursor->SetWorldPosition(world.cursor.hitResults[i].position_);
-                return;
-            }
-        }
+    //Intersect the bubble's face planes instead of its triangles
+    const Ray cameraRay{ world.camera->camera_->GetScreenRay(0.5f,0.5f) };
+    float distance{};
+
+    if (world.scene->GetComponent<World>()->Raycast(cameraRay, distance, 5.0f * WORLD_RADIUS)) {
+
+        world.cursor.hitDistance = distance;
+        world.cursor.sceneCursor->SetWorldPosition(cameraRay.origin_ + cameraRay.direction_ * distance);
+    } else {
+
+        world.cursor.hitDistance = M_INFINITY;
     }
 }
 
-bool MasterControl::CursorRayCast(float maxDistance, PODVector<RayQueryResult> &hitResults)
+bool MasterControl::CursorPick(float maxDistance, PlatformPick& pick)
 {
-    Ray cameraRay{ world.camera->camera_->GetScreenRay(0.5f,0.5f) };
-    RayOctreeQuery query{ hitResults, cameraRay, RAY_TRIANGLE, maxDistance, DRAWABLE_GEOMETRY };
-
-    world.scene->GetComponent<Octree>()->Raycast(query);
-
-    if (hitResults.Size())
-        return true;
-    else
-        return false;
+    const Ray cameraRay{ world.camera->camera_->GetScreenRay(0.5f,0.5f) };
+    return world.scene->GetComponent<World>()->Pick(cameraRay, maxDistance, pick);
 }
 
 void MasterControl::Exit()
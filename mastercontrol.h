@@ -35,6 +35,7 @@ using namespace Urho3D;
 class OneiroCam;
 class InputMaster;
 class Platform;
+struct PlatformPick;
 
 typedef struct GameWorld
 {
@@ -46,7 +47,8 @@ typedef struct GameWorld
     struct {
         Node* sceneCursor;
         Cursor* uiCursor;
-        PODVector<RayQueryResult> hitResults;
+        //Along the camera ray to the bubble, infinite when it is missed
+        float hitDistance;
     } cursor;
 } GameWorld;
 
@@ -66,6 +68,9 @@ StringHash const N_SLOT = StringHash("Slot");
 }
 
 #define WORLD_RADIUS 235.0f
+//View mask bits separating platforms from scenery in octree queries
+#define VM_SCENERY  1u
+#define VM_PLATFORM 2u
 
 class MasterControl : public Application
 {
@@ -75,6 +80,7 @@ public:
     MasterControl(Context* context);
     static MasterControl* GetInstance();
     Scene* GetScene() const { return world.scene; }
+    unsigned GetWorldSeed() const { return worldSeed_; }
 
     GameWorld world;
 
@@ -91,6 +97,7 @@ private:
     static MasterControl* instance_;
 
     bool paused_;
+    unsigned worldSeed_;
 
     SharedPtr<UI> ui_;
     SharedPtr<XMLFile> defaultStyle_;
@@ -108,7 +115,7 @@ private:
 
     void CreatePlatform(const Vector3 pos);
     void UpdateCursor(float timeStep);
-    bool CursorRayCast(float maxDistance, PODVector<RayQueryResult> &hitResults);
+    bool CursorPick(float maxDistance, PlatformPick& pick);
 };
 
 #endif // MASTERCONTROL_H
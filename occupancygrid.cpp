@@ -0,0 +1,200 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "occupancygrid.h"
+
+namespace {
+//Same order as the Neighbour enum
+const IntVector2 NEIGHBOUR_SHIFTS[8]{ IntVector2( 0,  1), IntVector2( 1,  1),
+                                      IntVector2( 1,  0), IntVector2( 1, -1),
+                                      IntVector2( 0, -1), IntVector2(-1, -1),
+                                      IntVector2(-1,  0), IntVector2(-1,  1) };
+}
+
+OccupancyGrid::OccupancyGrid():
+    origin_{},
+    width_{0},
+    height_{0},
+    bits_{},
+    buildings_{}
+{
+}
+
+void OccupancyGrid::Set(GridLayer layer, const IntVector2& coords, bool occupied)
+{
+    int index{ IndexOf(coords) };
+
+    if (index < 0) {
+
+        if (!occupied)
+            return;
+
+        Fit(coords);
+        index = IndexOf(coords);
+    }
+
+    const unsigned bit{ 1u << (index & 31) };
+
+    if (occupied)
+        bits_[layer][index >> 5] |= bit;
+    else
+        bits_[layer][index >> 5] &= ~bit;
+}
+
+void OccupancyGrid::SetBuilding(const IntVector2& coords, unsigned char building)
+{
+    int index{ IndexOf(coords) };
+
+    if (index < 0) {
+
+        if (!building)
+            return;
+
+        Fit(coords);
+        index = IndexOf(coords);
+    }
+
+    buildings_[index] = building;
+}
+
+unsigned char OccupancyGrid::GetNeighbourMask(const IntVector2& coords, GridLayer layer) const
+{
+    unsigned char mask{ 0 };
+
+    for (int n{0}; n < 8; ++n)
+        mask |= Has(layer, coords + NEIGHBOUR_SHIFTS[n]) << n;
+
+    return mask;
+}
+
+void OccupancyGrid::GetRects(PODVector<IntRect>& rects, GridLayer layer) const
+{
+    rects.Clear();
+
+    PODVector<unsigned char> covered{};
+    covered.Resize(width_ * height_);
+    memset(covered.Buffer(), 0, covered.Size());
+
+    auto available = [&](int x, int y) {
+        const int index{ y * width_ + x };
+        return ((bits_[layer][index >> 5] >> (index & 31)) & 1u) && !covered[index];
+    };
+
+    for (int y{0}; y < height_; ++y) {
+        for (int x{0}; x < width_; ++x) {
+
+            if (!available(x, y))
+                continue;
+
+            //Extend along the row, then add rows while the whole span fits
+            int right{ x + 1 };
+            while (right < width_ && available(right, y))
+                ++right;
+
+            int bottom{ y + 1 };
+            for (; bottom < height_; ++bottom) {
+
+                bool fits{ true };
+                for (int i{x}; i < right && fits; ++i)
+                    fits = available(i, bottom);
+
+                if (!fits)
+                    break;
+            }
+
+            for (int j{y}; j < bottom; ++j)
+                memset(&covered[j * width_ + x], 1, right - x);
+
+            rects.Push(IntRect(origin_.x_ + x, origin_.y_ + y,
+                               origin_.x_ + right, origin_.y_ + bottom));
+        }
+    }
+}
+
+void OccupancyGrid::Clear()
+{
+    origin_ = IntVector2::ZERO;
+    width_ = height_ = 0;
+
+    for (int l{0}; l < GL_LENGTH; ++l)
+        bits_[l].Clear();
+
+    buildings_.Clear();
+}
+
+void OccupancyGrid::Fit(const IntVector2& coords)
+{
+    //Grow to at least double the size so repeated growth stays amortized
+    const int margin{ 4 };
+    IntVector2 min{ origin_ };
+    IntVector2 max{ origin_ + IntVector2(width_, height_) };
+
+    if (!width_ || !height_)
+        min = max = coords;
+
+    if (coords.x_ < min.x_)
+        min.x_ = coords.x_ - Max(width_, margin);
+    else if (coords.x_ >= max.x_)
+        max.x_ = coords.x_ + 1 + Max(width_, margin);
+
+    if (coords.y_ < min.y_)
+        min.y_ = coords.y_ - Max(height_, margin);
+    else if (coords.y_ >= max.y_)
+        max.y_ = coords.y_ + 1 + Max(height_, margin);
+
+    const IntVector2 newOrigin{ min };
+    const int newWidth{ max.x_ - min.x_ };
+    const int newHeight{ max.y_ - min.y_ };
+    const unsigned cells{ static_cast<unsigned>(newWidth * newHeight) };
+
+    PODVector<unsigned> newBits[GL_LENGTH];
+    PODVector<unsigned char> newBuildings{};
+    newBuildings.Resize(cells);
+    memset(newBuildings.Buffer(), 0, cells);
+
+    for (int l{0}; l < GL_LENGTH; ++l) {
+
+        newBits[l].Resize((cells + 31) >> 5);
+        memset(newBits[l].Buffer(), 0, newBits[l].Size() * sizeof(unsigned));
+    }
+
+    for (int y{0}; y < height_; ++y) {
+        for (int x{0}; x < width_; ++x) {
+
+            const int oldIndex{ y * width_ + x };
+            const int newIndex{ (y + origin_.y_ - newOrigin.y_) * newWidth + (x + origin_.x_ - newOrigin.x_) };
+
+            for (int l{0}; l < GL_LENGTH; ++l) {
+
+                if ((bits_[l][oldIndex >> 5] >> (oldIndex & 31)) & 1u)
+                    newBits[l][newIndex >> 5] |= 1u << (newIndex & 31);
+            }
+
+            newBuildings[newIndex] = buildings_[oldIndex];
+        }
+    }
+
+    origin_ = newOrigin;
+    width_ = newWidth;
+    height_ = newHeight;
+
+    for (int l{0}; l < GL_LENGTH; ++l)
+        bits_[l] = newBits[l];
+
+    buildings_ = newBuildings;
+}
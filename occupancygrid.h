@@ -0,0 +1,78 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef OCCUPANCYGRID_H
+#define OCCUPANCYGRID_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+
+enum GridLayer { GL_TILE = 0, GL_SLOT, GL_DIRTY, GL_LENGTH };
+
+//Dense occupancy bits and building types for a platform's coordinates.
+//The covered area grows to fit whatever is set; reads outside it are empty.
+class OccupancyGrid
+{
+public:
+    OccupancyGrid();
+
+    bool Has(GridLayer layer, const IntVector2& coords) const
+    {
+        const int index{ IndexOf(coords) };
+        return index >= 0 && ((bits_[layer][index >> 5] >> (index & 31)) & 1u);
+    }
+    bool HasTile(const IntVector2& coords) const { return Has(GL_TILE, coords); }
+    bool HasSlot(const IntVector2& coords) const { return Has(GL_SLOT, coords); }
+    void Set(GridLayer layer, const IntVector2& coords, bool occupied);
+
+    unsigned char GetBuilding(const IntVector2& coords) const
+    {
+        const int index{ IndexOf(coords) };
+        return index >= 0 ? buildings_[index] : 0;
+    }
+    void SetBuilding(const IntVector2& coords, unsigned char building);
+
+    //One bit per neighbour, in Neighbour order starting at north
+    unsigned char GetNeighbourMask(const IntVector2& coords, GridLayer layer = GL_TILE) const;
+    //Covers a layer with few rectangles by greedy merging; right and bottom are exclusive
+    void GetRects(PODVector<IntRect>& rects, GridLayer layer = GL_TILE) const;
+
+    void Clear();
+
+private:
+    int IndexOf(const IntVector2& coords) const
+    {
+        //Unsigned comparison folds the lower bound checks into the upper ones
+        const unsigned x{ static_cast<unsigned>(coords.x_ - origin_.x_) };
+        const unsigned y{ static_cast<unsigned>(coords.y_ - origin_.y_) };
+
+        if (x < static_cast<unsigned>(width_) && y < static_cast<unsigned>(height_))
+            return static_cast<int>(y * width_ + x);
+        else
+            return -1;
+    }
+    void Fit(const IntVector2& coords);
+
+    IntVector2 origin_;
+    int width_;
+    int height_;
+    PODVector<unsigned> bits_[GL_LENGTH];
+    PODVector<unsigned char> buildings_;
+};
+
+#endif // OCCUPANCYGRID_H
@@ -150,7 +150,9 @@ void OneiroCam::Update(float timeStep)
 }
 bool OneiroCam::IsOut()
 {
-    return altitudeNode_->GetWorldPosition().ProjectOntoAxis(GetScene()->GetComponent<World>()->GetNearestRhombicCenter(altitudeNode_->GetWorldPosition())) > WORLD_RADIUS;
+    float height{};
+    GetScene()->GetComponent<World>()->GetFace(altitudeNode_->GetWorldPosition(), &height);
+    return height > WORLD_RADIUS;
 }
 
 void OneiroCam::Lock(Platform* platform)
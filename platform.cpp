@@ -16,10 +16,23 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+#include <Bullet/BulletDynamics/Dynamics/btRigidBody.h>
+#include <Bullet/BulletCollision/CollisionShapes/btCompoundShape.h>
+#include <Bullet/BulletCollision/CollisionShapes/btEmptyShape.h>
+
 #include "platform.h"
 #include "tile.h"
 #include "slot.h"
 #include "world.h"
+#include "autotile.h"
+#include "platformgenerator.h"
+#include "layoutmaster.h"
+#include "terrainbaker.h"
+#include "propulsion.h"
+#include "fropfield.h"
+#include "vegetation.h"
+#include "shelldynamics.h"
+#include "shellindex.h"
 
 namespace Urho3D {
 template <> unsigned MakeHash(const IntVector2& value)
@@ -30,20 +43,55 @@ template <> unsigned MakeHash(const IntVector2& value)
 
 //HashMap<StringHash, StaticModelGroup*> Platform::modelGroups_{};
 
+namespace {
+//Compound child that neither collides nor adds inertia, shared by all platforms
+class Ballast : public btEmptyShape
+{
+public:
+    void calculateLocalInertia(btScalar mass, btVector3& inertia) const override { (void)mass; inertia.setZero(); }
+};
+
+Ballast ballast{};
+}
+
 void Platform::RegisterObject(Context *context)
 {
     context->RegisterFactory<Platform>();
 }
 
 int Platform::platformCount_{};
+unsigned Platform::platformsSeeded_{};
+bool Platform::bakeTerrain_{false};
 
 Platform::Platform(Context *context):
     SceneObject(context),
+    tileBounds_{},
+    seed_{},
+    editRandom_{},
+    fropRandom_{},
+    impRandom_{},
+    layoutItem_{},
     selected_{false},
     modelGroups_{},
-    slotGroup_{}
+    slotVisuals_{},
+    terrainModel_{},
+    colliders_{},
+    collisionDirty_{false},
+    massProperties_{},
+    massDirty_{false},
+    propulsion_{},
+    fropField_{},
+    grass_{}
 {
     ++platformCount_;
+
+    //Core mass at the origin
+    massProperties_.Add(Vector3::ZERO, 1.0f);
+}
+
+Platform::~Platform()
+{
+    CancelLayout();
 }
 
 void Platform::OnNodeSet(Node *node)
@@ -70,73 +118,23 @@ void Platform::OnNodeSet(Node *node)
     rigidBody_->SetAngularFactor(Vector3(0.0f, 1.0f, 0.0f));
 //    rigidBody_->SetUseGravity(false);
 
+    propulsion_ = node_->CreateComponent<Propulsion>();
+    fropField_ = node_->CreateComponent<FropField>();
+    GetScene()->GetComponent<ShellDynamics>()->AddPlatform(this);
+    //Placed by ShellDynamics as the platform moves
+    GetScene()->GetComponent<ShellIndex>()->Insert(node_, GetType());
+
     Realign(1.0f);
 
 
-    if (!slotGroup_) {
-        slotGroup_ = node_->CreateComponent<StaticModelGroup>();
-        slotGroup_->SetModel(RESOURCE->GetModel("Slot"));
-        slotGroup_->SetMaterial(RESOURCE->GetMaterial("Glow"));
-        slotGroup_->SetCastShadows(true);
-    }
-
-    // Add base tile
-    IntVector2 firstCoordPair{ IntVector2(0,0) };
-    AddTile(firstCoordPair);
-    // Add random tiles
-
-    bool symmetrical{ true };//static_cast<bool>(Random(2))};
-    int addedTiles{ 1 };
-    int platformSize{ Ceil(Random(1, 64) * Pow(Random(0.5, 1.5f), 2.0f)) };
-
-    while (addedTiles < platformSize) {
-        //Pick a random exsisting tile
-        Vector<IntVector2> coordsVector{ tileMap_.Keys() };
-        IntVector2 randomTileCoords{ coordsVector[Random((int)coordsVector.Size())] };
-
-        if (randomTileCoords.x_ < 0 && symmetrical)
-            randomTileCoords.x_ = -randomTileCoords.x_;
-
-        char startDir{ NB_NORTH };//static_cast<char>(Random(NB_LENGTH))};
-        bool clockWise{ Random(2) };
-        if (clockWise)
-            startDir -= 3;
-
-        for (int direction{startDir}; LucKey::Delta(direction, startDir) < NB_LENGTH; clockWise ? direction += 2 : direction -= 2) {
-
-            int cycledDir{ LucKey::Cycle(direction, NB_NORTH, NB_NORTHWEST) };
-            assert((cycledDir >= NB_NORTH) && (cycledDir < NB_LENGTH));
-            Neighbour neighbour{ static_cast<Neighbour>(cycledDir) };
-            if (CheckEmptyNeighbour(randomTileCoords, neighbour, true)) {
-
-                IntVector2 newTileCoords{ GetNeighbourCoords(randomTileCoords, neighbour) };
-
-                Tile* newTile{ AddTile(newTileCoords) };
-                ++addedTiles;
-                if (symmetrical) {
-                    if (Abs(newTileCoords.x_) % 2 == 1 && newTileCoords.y_ <= 0){
-                        newTile->SetBuilding(B_ENGINE);
-                    }
-                    if (newTileCoords.x_ != 0) {
-
-                        newTileCoords = IntVector2(-newTileCoords.x_, newTileCoords.y_);
-                        newTile = AddTile(newTileCoords);
-                        ++addedTiles;
-
-                        if (Abs(newTileCoords.x_) % 2 == 1 && newTileCoords.y_ <= 0){
-                            newTile->SetBuilding(B_ENGINE);
-                        }
-                    }
-                }
-            }
-        }
+    if (!slotVisuals_) {
+        slotVisuals_ = node_->CreateComponent<Vegetation>();
+        slotVisuals_->SetModel(RESOURCE->GetModel("Slot"));
+        slotVisuals_->SetMaterial(RESOURCE->GetMaterial("Glow"));
+        slotVisuals_->SetCastShadows(true);
+        slotVisuals_->SetViewMask(VM_PLATFORM);
     }
 
-    //Add slots
-    AddMissingSlots();
-    Deselect();
-    DisableSlots();
-    FixFringe();
 
 }
 
@@ -152,43 +150,169 @@ void Platform::Set(Vector3 position)
 //    worldConstraint->SetPosition(-platformPos);
 //    worldConstraint->SetOtherPosition();
 
+    //Platforms are seeded in spawn order, independent of when their layouts complete
+    seed_ = RandomStream::Derive(MC->GetWorldSeed(), ++platformsSeeded_);
+    editRandom_.Seed(RandomStream::Derive(seed_, RC_EDITS));
+    fropRandom_.Seed(RandomStream::Derive(seed_, RC_FROPS));
+    impRandom_.Seed(RandomStream::Derive(seed_, RC_IMPS));
+    RandomStream placement{ RandomStream::Derive(seed_, RC_PLACEMENT) };
+
     Realign(1.0f);
-    node_->Rotate(Quaternion(Random(360.0f), Vector3::UP));
+    node_->Rotate(Quaternion(placement.Random(360.0f), Vector3::UP));
 
+    //Enabling the body makes Urho recalculate its mass from the shapes
+    RequestUpdate();
+    QueueLayout();
 
 }
 
-void Platform::Start()
+void Platform::Disable()
 {
+    CancelLayout();
+    Deselect();
+
+    //Return tiles and slots one by one so they take their mass, engines and instances along
+    for (Tile* tile : tileMap_.Values())
+        tile->Disable();
+    for (Slot* slot : slotMap_.Values())
+        slot->Disable();
+
+    //A recycled platform starts out empty when set again
+    tileMap_.Clear();
+    slotMap_.Clear();
+    occupancy_.Clear();
+    dirtyCells_.Clear();
+    tileBounds_ = IntRect::ZERO;
+
+    for (CollisionShape* collider : colliders_)
+        node_->RemoveComponent(collider);
+    colliders_.Clear();
+    rigidBody_->GetCompoundShape()->removeChildShape(&ballast);
+    collisionDirty_ = false;
+
+    if (terrainModel_)
+        terrainModel_->SetModel(nullptr);
+    if (grass_)
+        grass_->SetInstances(PODVector<Matrix3x4>{});
+
+    massProperties_.Clear();
+    massProperties_.Add(Vector3::ZERO, 1.0f);
+    massDirty_ = false;
+
+    SceneObject::Disable();
 }
 
-void Platform::Stop()
+void Platform::QueueLayout()
+{
+    if (!layoutItem_)
+        layoutItem_ = GetSubsystem<LayoutMaster>()->Request(this, seed_);
+}
+
+void Platform::CancelLayout()
 {
+    if (!layoutItem_)
+        return;
+
+    //Gone during shutdown, when no layout will be handed out anymore
+    if (LayoutMaster* layouts{ GetSubsystem<LayoutMaster>() })
+        layouts->Cancel(layoutItem_);
+
+    layoutItem_ = nullptr;
 }
 
-bool Platform::EnableSlot(IntVector2 coords)
+void Platform::BuildLayout(const PlatformLayout& layout)
 {
-    slotGroup_->AddInstanceNode(slotMap_[coords]->GetNode());
+    layoutItem_ = nullptr;
+
+    Instantiate(layout);
+    CommitEdits();
 }
-void Platform::EnableSlots()
+
+void Platform::Instantiate(const PlatformLayout& layout)
 {
-    for (unsigned i{0}; i < slotMap_.Values().Size(); ++i) {
-        if (GetBuildingType(slotMap_.Values()[i]->coords_) <= B_EMPTY)
-            EnableSlot(slotMap_.Values()[i]->coords_);
+    unsigned prop{ 0 };
+
+    for (unsigned t{0}; t < layout.tiles_.Size(); ++t) {
+
+        const IntVector2 coords{ layout.tiles_[t] };
+        Tile* tile{ AddTile(coords) };
+
+        if (layout.buildings_[t] != B_EMPTY)
+            SetBuilding(coords, static_cast<BuildingType>(layout.buildings_[t]));
+
+        const unsigned numProps{ layout.propCounts_[t] };
+        tile->Decorate(static_cast<TileExtra>(layout.extras_[t]),
+                       numProps ? &layout.props_[prop] : nullptr, numProps);
+        prop += numProps;
     }
 }
 
-bool Platform::DisableSlot(IntVector2 coords)
+Tile* Platform::BuildTile(IntVector2 coords)
+{
+    PlatformLayout layout{};
+    layout.tiles_.Push(coords);
+    layout.buildings_.Push(B_EMPTY);
+
+    PlatformGenerator(editRandom_.Next()).Decorate(layout);
+    Instantiate(layout);
+
+    return tileMap_[coords];
+}
+
+void Platform::Start()
 {
-    if (slotMap_[coords])
-        slotGroup_->RemoveInstanceNode(slotMap_[coords]->GetNode());
 }
-void Platform::DisableSlots()
+
+void Platform::Stop()
 {
-    for (Slot* s : slotMap_.Values()) {
-        if (s)
-            DisableSlot(s->coords_);
+}
+
+void Platform::UpdateSlotScales(const Vector3& cursor)
+{
+    //Cursor in coordinate space, sliced at the slot plane
+    const float nodeScale{ node_->GetWorldScale().x_ };
+    const Vector3 center{ node_->WorldToLocal(cursor) + offset_ };
+    const float radius{ SLOT_HOVER_RADIUS / nodeScale };
+    const float discSquared{ radius * radius - center.y_ * center.y_ };
+
+    //Slots near the cursor are handed to the visuals as one batch of transforms
+    PODVector<Matrix3x4> transforms{};
+
+    if (discSquared <= 0.0f) {
+
+        slotVisuals_->SetInstances(transforms);
+        return;
     }
+
+    const float disc{ Sqrt(discSquared) };
+    const int minY{ Max(CeilToInt(center.z_ - disc), tileBounds_.top_ - 1) };
+    const int maxY{ Min(FloorToInt(center.z_ + disc), tileBounds_.bottom_ + 1) };
+
+    for (int y{minY}; y <= maxY; ++y) {
+
+        const float dy{ y - center.z_ };
+        const float span{ Sqrt(Max(discSquared - dy * dy, 0.0f)) };
+        const int minX{ Max(CeilToInt(center.x_ - span), tileBounds_.left_ - 1) };
+        const int maxX{ Min(FloorToInt(center.x_ + span), tileBounds_.right_ + 1) };
+
+        for (int x{minX}; x <= maxX; ++x) {
+
+            const IntVector2 coords{ x, y };
+            if (!occupancy_.HasSlot(coords))
+                continue;
+
+            const float dx{ x - center.x_ };
+            const float distance{ Max(0.0f, Sqrt(dx * dx + dy * dy + center.y_ * center.y_) * nodeScale - 2.0f) };
+            float scale{ Clamp(1.0f - (0.1f * distance), 0.0f, 1.0f) };
+            for (int i{0}; i < 3; ++i)
+                scale *= scale;
+
+            if (scale > 0.0f)
+                transforms.Push(Matrix3x4(CoordsToPosition(coords), Quaternion::IDENTITY, scale));
+        }
+    }
+
+    slotVisuals_->SetInstances(transforms);
 }
 
 void Platform::Select()
@@ -197,7 +321,6 @@ void Platform::Select()
         return;
 
     selected_ = true;
-    EnableSlots();
 }
 
 void Platform::Deselect()
@@ -206,7 +329,7 @@ void Platform::Deselect()
         return;
 
     selected_ = false;
-    DisableSlots();
+    slotVisuals_->SetInstances(PODVector<Matrix3x4>{});
 }
 
 void Platform::SetSelected(bool select)
@@ -223,8 +346,13 @@ bool Platform::IsSelected() const
 void Platform::Realign(float timeStep)
 {
     World* world{ GetScene()->GetComponent<World>() };
-    Vector3 up{ -world->GetNearestRhombicCenter(node_->GetWorldPosition()).Normalized() };
-    up = node_->GetUp().Lerp(up, Min(1.0f, 5.0f * timeStep));
+    Realign(timeStep, world->GetFaceNormal(world->GetFace(node_->GetWorldPosition())));
+}
+
+void Platform::Realign(float timeStep, const Vector3& faceNormal)
+{
+    World* world{ GetScene()->GetComponent<World>() };
+    Vector3 up{ node_->GetUp().Lerp(-faceNormal, Min(1.0f, 5.0f * timeStep)) };
     Vector3 newDirection{ node_->GetDirection() - node_->GetDirection().DotProduct(up) * up };
     newDirection = node_->GetDirection().Lerp(newDirection, Min(1.0f, 2.0f * timeStep));
 
@@ -234,23 +362,106 @@ void Platform::Realign(float timeStep)
 }
 
 void Platform::Update(float timeStep)
+{ (void)timeStep;
+
+    //Only subscribed while collision or mass need updating,
+    //shell gravity and alignment are handled by ShellDynamics
+    UpdateCenterOfMass();
+    SetUpdateEventMask(0);
+}
+
+void Platform::RequestUpdate()
+{
+    SetUpdateEventMask(USE_UPDATE);
+}
+
+void Platform::UpdateCollision()
+{
+    //One box per merged rectangle of tiles
+    PODVector<IntRect> rects{};
+    occupancy_.GetRects(rects);
+
+    for (unsigned r{0}; r < rects.Size(); ++r) {
+
+        const IntRect& rect{ rects[r] };
+
+        if (r == colliders_.Size())
+            colliders_.Push(node_->CreateComponent<CollisionShape>());
+
+        const Vector3 size{ static_cast<float>(rect.Width()), 0.5f, static_cast<float>(rect.Height()) };
+        const Vector3 center{ -offset_ + Vector3((rect.left_ + rect.right_ - 1) * 0.5f,
+                                                 0.0f,
+                                                 (rect.top_ + rect.bottom_ - 1) * 0.5f) };
+        //Unchanged boxes keep their compound child
+        if (colliders_[r]->GetSize() != size || colliders_[r]->GetPosition() != center)
+            colliders_[r]->SetBox(size, center);
+    }
+
+    while (colliders_.Size() > rects.Size()) {
+
+        node_->RemoveComponent(colliders_.Back());
+        colliders_.Pop();
+    }
+
+    collisionDirty_ = false;
+}
+
+void Platform::AddMass(IntVector2 coords, float mass)
+{
+    //Solid box of tile size around the tile's center
+    const Vector3 boxInertia{ Vector3(0.25f + 1.0f, 1.0f + 1.0f, 1.0f + 0.25f) / 12.0f };
+
+    massProperties_.Add(CoordsToPosition(coords), mass, boxInertia * mass);
+    massDirty_ = true;
+    RequestUpdate();
+}
+
+void Platform::PlaceBallast()
+{
+    //Urho puts the center of mass at the mean of the compound's children, however
+    //many tiles each covers. One extra child moves that mean onto the actual center.
+    btCompoundShape* compound{ rigidBody_->GetCompoundShape() };
+    compound->removeChildShape(&ballast);
+
+    const int numShapes{ compound->getNumChildShapes() };
+    if (!numShapes)
+        return;
+
+    btVector3 sum{ 0.0f, 0.0f, 0.0f };
+    for (int s{0}; s < numShapes; ++s)
+        sum += compound->getChildTransform(s).getOrigin();
+
+    //Child transforms include the node's scale
+    const Vector3 center{ massProperties_.GetCenter() * node_->GetWorldScale() };
+    btTransform transform{};
+    transform.setIdentity();
+    transform.setOrigin(btVector3(center.x_, center.y_, center.z_) * static_cast<btScalar>(numShapes + 1) - sum);
+    compound->addChildShape(transform, &ballast);
+}
+
+void Platform::UpdateCenterOfMass()
 {
-    Vector3 rhombicCenter{ GetScene()->GetComponent<World>()->GetNearestRhombicCenter(node_->GetWorldPosition()) };
+    //Suspend mass updates so shape and mass changes cost one recalculation
+    rigidBody_->DisableMassUpdate();
 
-//    node_->GetComponent<Constraint>()->SetAxis(-node_->GetWorldPosition().Normalized());
+    if (collisionDirty_)
+        UpdateCollision();
 
-    float out{ (node_->GetWorldPosition() - rhombicCenter).ProjectOntoAxis(rhombicCenter) };
+    rigidBody_->SetMass(massProperties_.GetMass());
+    PlaceBallast();
+    rigidBody_->EnableMassUpdate();
 
-    Vector3 newG{ -23.0f * out * Sign(out) * out * rhombicCenter.Normalized() };
-    rigidBody_->SetGravityOverride(newG);
+    //Replace the inertia Urho derives from the shapes by that of the actual
+    //mass distribution, around the center the body now rotates about
+    btRigidBody* body{ rigidBody_->GetBody() };
+    const Vector3 inertia{ massProperties_.GetInertia(massProperties_.GetCenter()) };
+    body->setMassProps(massProperties_.GetMass(), btVector3(inertia.x_, inertia.y_, inertia.z_));
+    body->updateInertiaTensor();
 
-//    node_->SetWorldPosition(node_->GetWorldPosition().Normalized() * WORLD_RADIUS);
-//rig
-    if (rigidBody_->IsActive())
-        Realign(timeStep);
+    massDirty_ = false;
 }
 
-void Platform::AddNodeInstance(String model, Node* node)
+StaticModelGroup* Platform::AddNodeInstance(String model, Node* node)
 {
     StringHash modelHash{ model.ToHash() };
 
@@ -259,10 +470,29 @@ void Platform::AddNodeInstance(String model, Node* node)
         modelGroups_[modelHash]->SetModel(RESOURCE->GetModel(model));
         modelGroups_[modelHash]->SetMaterial(RESOURCE->GetMaterial("VCol"));
         modelGroups_[modelHash]->SetCastShadows(true);
+        modelGroups_[modelHash]->SetViewMask(VM_PLATFORM);
     }
 
-    modelGroups_[modelHash]->AddInstanceNode(node);
+    StaticModelGroup* group{ modelGroups_[modelHash] };
+    group->AddInstanceNode(node);
+
+    return group;
 }
+Vegetation* Platform::GetGrass()
+{
+    if (!grass_) {
+
+        grass_ = node_->CreateComponent<Vegetation>();
+        grass_->SetModel(CACHE->GetResource<Model>("Resources/Models/Grass.mdl"));
+        grass_->SetMaterial(0, CACHE->GetResource<Material>("Resources/Materials/BlockCenter.xml"));
+        grass_->SetMaterial(1, CACHE->GetResource<Material>("Resources/Materials/Shadow.xml"));
+        grass_->SetCastShadows(false);
+        grass_->SetViewMask(VM_SCENERY);
+    }
+
+    return grass_;
+}
+
 void Platform::Move(double timeStep)
 {
     /*Vector3 relativeMoveTarget = moveTarget_ - rootNode_->GetPosition();
@@ -272,59 +502,320 @@ void Platform::Move(double timeStep)
     }*/
 }
 
+Tile* Platform::GetTile(IntVector2 coords) const
+{
+    HashMap<IntVector2, Tile*>::ConstIterator t{ tileMap_.Find(coords) };
+    return t != tileMap_.End() ? t->second_ : nullptr;
+}
+
+Sphere Platform::GetBoundingSphere() const
+{
+    const Vector3 center{ -offset_ + Vector3((tileBounds_.left_ + tileBounds_.right_) * 0.5f, 0.0f,
+                                             (tileBounds_.top_ + tileBounds_.bottom_) * 0.5f) };
+    //Slots border the tiles, reaching one and a half units past their coordinates
+    const float radius{ 0.5f * Vector3(tileBounds_.Width() + 3.0f,
+                                       2.0f * PLATFORM_HALF_THICKNESS,
+                                       tileBounds_.Height() + 3.0f).Length() };
+
+    return Sphere(node_->LocalToWorld(center), radius * node_->GetWorldScale().x_);
+}
+
+bool Platform::Pick(const Ray& ray, float maxDistance, PlatformPick& pick)
+{
+    if (tileMap_.Empty())
+        return false;
+
+    //Ray in coordinate space, where cells are centered on integer x and z.
+    //The direction keeps its scale so distances stay in world units.
+    const Vector3 origin{ node_->WorldToLocal(ray.origin_) + offset_ };
+    const Vector3 direction{ node_->GetWorldRotation().Inverse() * ray.direction_ / node_->GetWorldScale().x_ };
+
+    //Clip it to the slab holding the tiles and the ring of slots around them
+    const Vector3 min{ tileBounds_.left_ - 1.5f, -PLATFORM_HALF_THICKNESS, tileBounds_.top_ - 1.5f };
+    const Vector3 max{ tileBounds_.right_ + 1.5f, PLATFORM_HALF_THICKNESS, tileBounds_.bottom_ + 1.5f };
+    float enter{ 0.0f };
+    float exit{ maxDistance };
+
+    for (int a{0}; a < 3; ++a) {
+
+        const float o{ origin.Data()[a] };
+        const float d{ direction.Data()[a] };
+
+        if (Abs(d) < M_EPSILON) {
+
+            if (o < min.Data()[a] || o > max.Data()[a])
+                return false;
+
+        } else {
+
+            float in{ (min.Data()[a] - o) / d };
+            float out{ (max.Data()[a] - o) / d };
+            if (in > out)
+                Swap(in, out);
+
+            enter = Max(enter, in);
+            exit = Min(exit, out);
+        }
+    }
+
+    if (enter > exit)
+        return false;
+
+    //Step from cell to cell across whichever border comes first
+    const Vector3 start{ origin + direction * enter };
+    IntVector2 coords{ FloorToInt(start.x_ + 0.5f), FloorToInt(start.z_ + 0.5f) };
+    const IntVector2 step{ direction.x_ > 0.0f ? 1 : -1, direction.z_ > 0.0f ? 1 : -1 };
+    const Vector2 delta{ Abs(direction.x_) < M_EPSILON ? M_INFINITY : 1.0f / Abs(direction.x_),
+                         Abs(direction.z_) < M_EPSILON ? M_INFINITY : 1.0f / Abs(direction.z_) };
+    Vector2 next{ Abs(direction.x_) < M_EPSILON ? M_INFINITY : enter + (coords.x_ + 0.5f * step.x_ - start.x_) / direction.x_,
+                  Abs(direction.z_) < M_EPSILON ? M_INFINITY : enter + (coords.y_ + 0.5f * step.y_ - start.z_) / direction.z_ };
+    float distance{ enter };
+    //Slots are only shown, and so can only be hit, while the platform is selected
+    const bool slots{ IsSelected() };
+
+    while (distance <= exit) {
+
+        const bool tile{ occupancy_.HasTile(coords) };
+
+        if (tile || (slots && occupancy_.HasSlot(coords))) {
+
+            pick = PlatformPick{ this, coords, !tile, distance };
+            return true;
+        }
+
+        if (next.x_ < next.y_) {
+
+            distance = next.x_;
+            next.x_ += delta.x_;
+            coords.x_ += step.x_;
+        } else {
+
+            distance = next.y_;
+            next.y_ += delta.y_;
+            coords.y_ += step.y_;
+        }
+    }
+
+    return false;
+}
+
+void Platform::QueryTiles(PODVector<TileHit>& result, const Sphere& sphere)
+{
+    if (tileMap_.Empty())
+        return;
+
+    //Sphere in coordinate space, with tiles at integer x and z
+    const Vector3 center{ node_->WorldToLocal(sphere.center_) + offset_ };
+    const float radius{ sphere.radius_ / node_->GetWorldScale().x_ };
+
+    //Slice it at the tile plane
+    const float discSquared{ radius * radius - center.y_ * center.y_ };
+    if (discSquared < 0.0f)
+        return;
+
+    const float disc{ Sqrt(discSquared) };
+    const int minY{ Max(CeilToInt(center.z_ - disc), tileBounds_.top_) };
+    const int maxY{ Min(FloorToInt(center.z_ + disc), tileBounds_.bottom_) };
+
+    for (int y{minY}; y <= maxY; ++y) {
+
+        const float dy{ y - center.z_ };
+        const float span{ Sqrt(Max(discSquared - dy * dy, 0.0f)) };
+        const int minX{ Max(CeilToInt(center.x_ - span), tileBounds_.left_) };
+        const int maxX{ Min(FloorToInt(center.x_ + span), tileBounds_.right_) };
+
+        for (int x{minX}; x <= maxX; ++x) {
+
+            const IntVector2 coords{ x, y };
+            if (occupancy_.HasTile(coords))
+                result.Push(TileHit{ this, coords, node_->LocalToWorld(CoordsToPosition(coords)) });
+        }
+    }
+}
+
+void Platform::QueryTiles(PODVector<TileHit>& result, const Vector3& axis, float angle)
+{
+    if (tileMap_.Empty())
+        return;
+
+    //Core and axis in coordinate space; uniform scale leaves angles unchanged
+    const Vector3 core{ node_->WorldToLocal(Vector3::ZERO) + offset_ };
+    const Vector3 direction{ (node_->GetWorldRotation().Inverse() * axis).Normalized() };
+    const float cosine{ Cos(angle) };
+
+    for (int y{tileBounds_.top_}; y <= tileBounds_.bottom_; ++y) {
+        for (int x{tileBounds_.left_}; x <= tileBounds_.right_; ++x) {
+
+            const IntVector2 coords{ x, y };
+            if (!occupancy_.HasTile(coords))
+                continue;
+
+            const Vector3 fromCore{ Vector3(x, 0.0f, y) - core };
+            if (fromCore.DotProduct(direction) >= cosine * fromCore.Length())
+                result.Push(TileHit{ this, coords, node_->LocalToWorld(CoordsToPosition(coords)) });
+        }
+    }
+}
+
 Tile* Platform::AddTile(IntVector2 newTileCoords)
 {
     Tile* newTile{ SPAWN->Create<Tile>() };
-    newTile->Set(newTileCoords, this);
+
+    if (tileMap_.Empty()) {
+
+        tileBounds_ = IntRect(newTileCoords.x_, newTileCoords.y_, newTileCoords.x_, newTileCoords.y_);
+    } else {
+
+        tileBounds_.left_   = Min(tileBounds_.left_,   newTileCoords.x_);
+        tileBounds_.top_    = Min(tileBounds_.top_,    newTileCoords.y_);
+        tileBounds_.right_  = Max(tileBounds_.right_,  newTileCoords.x_);
+        tileBounds_.bottom_ = Max(tileBounds_.bottom_, newTileCoords.y_);
+    }
+
     tileMap_[newTileCoords] = newTile;
+    occupancy_.Set(GL_TILE, newTileCoords, true);
+    newTile->Set(newTileCoords, this);
+    MarkDirty(newTileCoords);
 
     return newTile;
 }
 
-void Platform::AddMissingSlots()
+void Platform::MarkDirty(IntVector2 coords)
 {
-    Vector<IntVector2> tileCoords{tileMap_.Keys()};
-    for (uint nthTile{0}; nthTile < tileCoords.Size(); ++nthTile){
-        for (int neighbour{ NB_NORTH }; neighbour < NB_LENGTH; ++neighbour){
-            IntVector2 checkCoords{ GetNeighbourCoords(tileCoords[nthTile], static_cast<Neighbour>(neighbour)) };
-            if (CheckEmpty(checkCoords, false)) {
-                Slot* newSlot{ SPAWN->Create<Slot>() };
-                slotMap_[checkCoords] = newSlot;
-                newSlot->Set(checkCoords, this);
+    //An edit can change the fringe and slots of the surrounding cells
+    for (int y{-1}; y <= 1; ++y) {
+        for (int x{-1}; x <= 1; ++x) {
+
+            const IntVector2 cell{ coords + IntVector2(x, y) };
+
+            if (!occupancy_.Has(GL_DIRTY, cell)) {
+                occupancy_.Set(GL_DIRTY, cell, true);
+                dirtyCells_.Push(cell);
             }
         }
     }
 }
 
-void Platform::FixFringe()
+void Platform::CommitEdits()
 {
+    if (dirtyCells_.Empty())
+        return;
+
+    for (const IntVector2& cell : dirtyCells_) {
+
+        occupancy_.Set(GL_DIRTY, cell, false);
+
+        if (!CheckEmpty(cell))
+            tileMap_[cell]->FixFringe();
+
+        UpdateSlot(cell);
+    }
+
+    dirtyCells_.Clear();
+    collisionDirty_ = true;
+    RequestUpdate();
+
+    //Queries find the platform by how far its tiles and slots reach from the node
+    const Sphere bounds{ GetBoundingSphere() };
+    GetScene()->GetComponent<ShellIndex>()->SetRadius(node_, (bounds.center_ - node_->GetWorldPosition()).Length() + bounds.radius_);
+
+    if (IsBaked())
+        BakeTerrain();
+}
+
+void Platform::BakeTerrain()
+{
+    const String key{ TerrainKey() };
+    SharedPtr<Model> model{ TerrainBaker::LoadCached(context_, key) };
+
+    if (!model) {
+
+        TerrainBaker baker{ context_ };
+
+        for (Tile* tile : tileMap_.Values())
+            tile->Bake(baker);
+
+        model = baker.Bake();
+        TerrainBaker::StoreCached(context_, model, key);
+    }
+
+    if (!terrainModel_) {
+        terrainModel_ = node_->CreateComponent<StaticModel>();
+        terrainModel_->SetCastShadows(true);
+        terrainModel_->SetViewMask(VM_PLATFORM);
+    }
+
+    terrainModel_->SetModel(model);
+    terrainModel_->SetMaterial(RESOURCE->GetMaterial("VCol"));
+}
+
+String Platform::TerrainKey() const
+{
+    //Sort tiles so the key does not depend on the order they were added in
     Vector<Tile*> tiles{ tileMap_.Values() };
-    for (unsigned tile{0}; tile < tiles.Size(); ++tile) {
-        tiles[tile]->FixFringe();
+    Sort(tiles.Begin(), tiles.End(), [](const Tile* lhs, const Tile* rhs) {
+        return lhs->coords_.y_ < rhs->coords_.y_
+           || (lhs->coords_.y_ == rhs->coords_.y_ && lhs->coords_.x_ < rhs->coords_.x_);
+    });
+
+    //64-bit FNV-1a over occupancy, pieces and variants
+    unsigned long long hash{ 14695981039346656037ull };
+    auto add = [&hash](int value) {
+        for (int b{0}; b < 4; ++b) {
+            hash ^= (static_cast<unsigned>(value) >> (b * 8)) & 0xffu;
+            hash *= 1099511628211ull;
+        }
+    };
+
+    add(TERRAIN_CACHE_VERSION);
+    add(static_cast<int>(tiles.Size()));
+
+    for (const Tile* tile : tiles) {
+
+        add(tile->coords_.x_);
+        add(tile->coords_.y_);
+
+        for (int e{0}; e < TE_LENGTH; ++e) {
+            add(tile->pieces_[e]);
+            add(tile->variants_[e]);
+        }
     }
+
+    return ToStringHex(static_cast<unsigned>(hash >> 32)) + ToStringHex(static_cast<unsigned>(hash));
 }
 
-void Platform::FixFringe(IntVector2 coords)
+void Platform::UpdateSlot(IntVector2 coords)
 {
-    for (int neighbour{0}; neighbour < NB_LENGTH; ++neighbour) {
-        IntVector2 neighbourCoords{ GetNeighbourCoords(coords, static_cast<Neighbour>(neighbour)) };
-        if (!CheckEmpty(neighbourCoords))
-            tileMap_[neighbourCoords]->FixFringe();
+    const bool needed{ CheckEmpty(coords) && occupancy_.GetNeighbourMask(coords) };
+    const bool present{ !CheckEmpty(coords, false) };
+
+    if (needed == present)
+        return;
+
+    if (needed) {
+
+        Slot* newSlot{ SPAWN->Create<Slot>() };
+        slotMap_[coords] = newSlot;
+        occupancy_.Set(GL_SLOT, coords, true);
+        newSlot->Set(coords, this);
+
+    } else {
+
+        Slot* slot{ slotMap_[coords] };
+        slotMap_.Erase(coords);
+        occupancy_.Set(GL_SLOT, coords, false);
+        slot->Disable();
     }
 }
 
 void Platform::SetBuilding(IntVector2 coords, BuildingType type)
 {
     tileMap_[coords]->SetBuilding(type);
-    FixFringe(coords);
 }
 
 bool Platform::CheckEmpty(IntVector2 coords, bool checkTiles) const
 {
-    if (checkTiles)
-        return (!tileMap_.Keys().Contains(coords));
-    else
-        return (!slotMap_.Keys().Contains(coords));
+    return !occupancy_.Has(checkTiles ? GL_TILE : GL_SLOT, coords);
 }
 
 
@@ -378,13 +869,9 @@ IntVector2 Platform::GetNeighbourCoords(IntVector2 coords, Neighbour element)
     return coords + shift;
 }
 
-BuildingType Platform::GetBuildingType(IntVector2 coords)
+BuildingType Platform::GetBuildingType(IntVector2 coords) const
 {
-    if (!CheckEmpty(coords)) {
-        return tileMap_[coords]->buildingType_;
-    } else {
-        return B_SPACE;
-    }
+    return static_cast<BuildingType>(occupancy_.GetBuilding(coords));
 }
 
 BuildingType Platform::GetNeighbourType(IntVector2 coords, Neighbour neighbour)
@@ -394,71 +881,18 @@ BuildingType Platform::GetNeighbourType(IntVector2 coords, Neighbour neighbour)
 
 CornerType Platform::PickCornerType(IntVector2 tileCoords, TileElement element) const
 {
-    char neighbourMask{ GetNeighbourMask(tileCoords, element) };
-
-    switch (neighbourMask) {
-
-    case 0:
-        return CT_IN;
-
-    case 1:
-        return CT_STRAIGHT;
-
-    case 2:
-        if (element == TE_NORTHEAST || element == TE_SOUTHEAST)
-            return CT_BRIDGE;
-
-        else return CT_NONE;
-
-    case 5:
-        return CT_OUT;
-
-    case 7:
-        return CT_FILL;
-
-    default:
-        return CT_NONE;
-    }
+    return AutoTile::Lookup(GetNeighbourMask(tileCoords)).elements_[element].type_;
 }
 char Platform::GetNeighbourMask(IntVector2 tileCoords, TileElement element) const
 {
-    int checkedNeighbours{ 3 };
-    bool emptyCheck[checkedNeighbours]{ true, true, true };
+    //Each element looks at three consecutive neighbours of the full mask
+    const unsigned mask{ GetNeighbourMask(tileCoords) };
 
     switch (element) {
-    case TE_NORTHEAST: {
-        emptyCheck[0] = CheckEmptyNeighbour(tileCoords, NB_NORTH);
-        emptyCheck[1] = CheckEmptyNeighbour(tileCoords, NB_NORTHEAST);
-        emptyCheck[2] = CheckEmptyNeighbour(tileCoords, NB_EAST);
-
+    case TE_NORTHEAST: return  mask       & 7u;
+    case TE_SOUTHEAST: return (mask >> 2) & 7u;
+    case TE_SOUTHWEST: return (mask >> 4) & 7u;
+    case TE_NORTHWEST: return ((mask >> 6) | (mask << 2)) & 7u;
+    default: return 0;
     }
-    break;
-    case TE_SOUTHEAST: {
-        emptyCheck[0] = CheckEmptyNeighbour(tileCoords, NB_EAST);
-        emptyCheck[1] = CheckEmptyNeighbour(tileCoords, NB_SOUTHEAST);
-        emptyCheck[2] = CheckEmptyNeighbour(tileCoords, NB_SOUTH);
-
-    }break;
-    case TE_SOUTHWEST: {
-        emptyCheck[0] = CheckEmptyNeighbour(tileCoords, NB_SOUTH);
-        emptyCheck[1] = CheckEmptyNeighbour(tileCoords, NB_SOUTHWEST);
-        emptyCheck[2] = CheckEmptyNeighbour(tileCoords, NB_WEST);
-
-    }break;
-    case TE_NORTHWEST: {
-        emptyCheck[0] = CheckEmptyNeighbour(tileCoords, NB_WEST);
-        emptyCheck[1] = CheckEmptyNeighbour(tileCoords, NB_NORTHWEST);
-        emptyCheck[2] = CheckEmptyNeighbour(tileCoords, NB_NORTH);
-
-    }break;
-    default: break;
-    }
-
-    int neighbourMask{0};
-
-    for (int i{ checkedNeighbours - 1 }; i >= 0; --i) {
-        neighbourMask += !emptyCheck[i] << i;
-    }
-
-    return neighbourMask;
 }
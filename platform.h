@@ -22,8 +22,15 @@
 #include <Urho3D/Urho3D.h>
 
 #include "sceneobject.h"
+#include "occupancygrid.h"
+#include "randomstream.h"
+#include "massproperties.h"
 
 #define PLATFORM_HALF_THICKNESS 0.23f
+//Slots farther than this from the cursor are shrunk away
+#define SLOT_HOVER_RADIUS 12.0f
+//Bump when the baked terrain output changes to invalidate cached meshes
+#define TERRAIN_CACHE_VERSION 2
 
 namespace Urho3D {
 class Drawable;
@@ -36,24 +43,56 @@ using namespace Urho3D;
 
 class Tile;
 class Slot;
+class Propulsion;
+class FropField;
+class Vegetation;
+class Platform;
+struct PlatformLayout;
 
 enum TileElement {TE_NORTHEAST = 0, TE_SOUTHEAST, TE_NORTHWEST, TE_SOUTHWEST, TE_LENGTH};
 enum Neighbour{ NB_NORTH = 0, NB_NORTHEAST, NB_EAST, NB_SOUTHEAST, NB_SOUTH, NB_SOUTHWEST, NB_WEST, NB_NORTHWEST, NB_LENGTH };
 enum CornerType {CT_NONE, CT_IN, CT_OUT, CT_STRAIGHT, CT_BRIDGE, CT_FILL};
 enum BuildingType {B_SPACE, B_EMPTY, B_ENGINE};
+enum TileExtra {TX_NONE, TX_SPIRE, TX_IMPS, TX_FIRE, TX_FROPS};
+
+//A tile found by a spatial query
+struct TileHit
+{
+    Platform* platform_;
+    IntVector2 coords_;
+    Vector3 position_;
+};
+
+//A tile or slot found along a ray
+struct PlatformPick
+{
+    Platform* platform_;
+    IntVector2 coords_;
+    bool slot_;
+    float distance_;
+};
 
 
 class Platform : public SceneObject
 {
     URHO3D_OBJECT(Platform, SceneObject);
     friend class InputMaster;
+    friend class Tile;
 public:
     Platform(Context *context);
+    ~Platform();
     static void RegisterObject(Context* context);
     virtual void OnNodeSet(Node* node);
     virtual void Set(Vector3 position);
+    void Disable() override;
+    //Called by the LayoutMaster once the requested layout is generated
+    void BuildLayout(const PlatformLayout& layout);
 
     static int platformCount_;
+    //Draw terrain from one merged mesh per platform instead of instanced pieces
+    static bool bakeTerrain_;
+    bool IsBaked() const { return bakeTerrain_; }
+    static unsigned platformsSeeded_;
     RigidBody* rigidBody_;
 
     bool CheckEmpty(Vector3 coords, bool checkTiles = true) const { return CheckEmpty(IntVector2(round(coords.x_), round(coords.z_)), checkTiles); }
@@ -61,41 +100,71 @@ public:
     bool CheckEmptyNeighbour(IntVector2 coords, Neighbour neighbour, bool checkTiles = true) const;
     static IntVector2 GetNeighbourCoords(IntVector2 coords, Neighbour element);
     CornerType PickCornerType(IntVector2 tileCoords, TileElement element) const;
-    BuildingType GetBuildingType(IntVector2 coords);
+    BuildingType GetBuildingType(IntVector2 coords) const;
     BuildingType GetNeighbourType(IntVector2 coords, Neighbour neighbour);
 
 
     virtual void Start();
     virtual void Stop();
-    void AddMissingSlots();
-    void FixFringe();
-    void FixFringe(IntVector2 coords);
+    void MarkDirty(IntVector2 coords);
+    void CommitEdits();
 
     Tile* AddTile(IntVector2 newTileCoords);
-    bool DisableSlot(IntVector2 coords);
-    bool EnableSlot(IntVector2 coords);
+    Tile* BuildTile(IntVector2 coords);
     void SetMoveTarget(Vector3 moveTarget) {moveTarget_ = moveTarget;}
-    void EnableSlots();
-    void DisableSlots();
+    //Scales the slots near the cursor in one pass over the occupancy grid
+    void UpdateSlotScales(const Vector3& cursor);
 
-    Vector3 CoordsToPosition(IntVector2 coords, float y = 0.0f) { return -offset_ + Vector3(coords.x_,
-                                                                                        y,
-                                                                                        coords.y_);
-                                                                       }
+    Vector3 CoordsToPosition(IntVector2 coords, float y = 0.0f) const { return -offset_ + Vector3(coords.x_,
+                                                                                              y,
+                                                                                              coords.y_);
+                                                                             }
     char GetNeighbourMask(IntVector2 tileCoords, TileElement element) const;
+    unsigned char GetNeighbourMask(IntVector2 tileCoords) const { return occupancy_.GetNeighbourMask(tileCoords); }
 
     void Realign(float timeStep);
+    void Realign(float timeStep, const Vector3& faceNormal);
 
     void Update(float timeStep) override;
     Vector3 GetNearestRhombicCenter();
 
-    void AddNodeInstance(String model, Node* node);
+    StaticModelGroup* AddNodeInstance(String model, Node* node);
+    //Grass tufts drawn as instances, created when first needed
+    Vegetation* GetGrass();
+    void AddMass(IntVector2 coords, float mass);
+    //The body rotates about this point as well
+    Vector3 GetCenterOfMass() const { return massProperties_.GetCenter(); }
+    Propulsion* GetPropulsion() const { return propulsion_; }
+
+    Tile* GetTile(IntVector2 coords) const;
+    //Encloses all tiles and slots, in world space
+    Sphere GetBoundingSphere() const;
+    //Nearest tile or slot along a ray, found by walking the grid
+    bool Pick(const Ray& ray, float maxDistance, PlatformPick& pick);
+    //Tiles with their centers inside a sphere
+    void QueryTiles(PODVector<TileHit>& result, const Sphere& sphere);
+    //Tiles with their centers within an angle of an axis through the core
+    void QueryTiles(PODVector<TileHit>& result, const Vector3& axis, float angle);
 
 private:
     HashMap<IntVector2, Tile*> tileMap_;
     HashMap<IntVector2, Slot*> slotMap_;
-    HashMap<IntVector2, BuildingType> buildingMap_;
+    OccupancyGrid occupancy_;
+    PODVector<IntVector2> dirtyCells_;
     Vector3 offset_;
+    //Coordinates spanned by tiles, inclusive
+    IntRect tileBounds_;
+
+    unsigned seed_;
+    RandomStream editRandom_;
+    RandomStream fropRandom_;
+    RandomStream impRandom_;
+
+    //Pending layout request, kept to cancel it
+    WorkItem* layoutItem_;
+    void QueueLayout();
+    void CancelLayout();
+    void Instantiate(const PlatformLayout& layout);
 
     bool selected_;
     Vector3 moveTarget_;
@@ -107,11 +176,27 @@ private:
 
     void SetBuilding(IntVector2 coords, BuildingType type = B_ENGINE);
     void RemoveBuilding(IntVector2 coords) {SetBuilding(coords, B_EMPTY);}
+    void UpdateSlot(IntVector2 coords);
     void UpdateCenterOfMass();
+    void PlaceBallast();
     void Move(double timeStep);
 
     HashMap<StringHash, StaticModelGroup*> modelGroups_;
-    StaticModelGroup* slotGroup_;
+    Vegetation* slotVisuals_;
+    StaticModel* terrainModel_;
+
+    PODVector<CollisionShape*> colliders_;
+    bool collisionDirty_;
+    void UpdateCollision();
+
+    MassProperties massProperties_;
+    bool massDirty_;
+    void RequestUpdate();
+    Propulsion* propulsion_;
+    FropField* fropField_;
+    Vegetation* grass_;
+    void BakeTerrain();
+    String TerrainKey() const;
 };
 
 #endif // PLATFORM_H
@@ -0,0 +1,136 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "platformgenerator.h"
+
+PlatformGenerator::PlatformGenerator(unsigned seed, bool symmetrical):
+    layoutRandom_{ RandomStream::Derive(seed, RC_LAYOUT) },
+    decorationRandom_{ RandomStream::Derive(seed, RC_DECORATION) },
+    symmetrical_{symmetrical},
+    grid_{},
+    frontier_{}
+{
+}
+
+int PlatformGenerator::RollSize()
+{
+    return static_cast<int>(Ceil(layoutRandom_.Random(1, 64) * Pow(layoutRandom_.Random(0.5f, 1.5f), 2.0f)));
+}
+
+void PlatformGenerator::Generate(int size, PlatformLayout& layout)
+{
+    grid_.Clear();
+    frontier_.Clear();
+    layout.tiles_.Clear();
+    layout.buildings_.Clear();
+
+    //Add base tile
+    AddTile(IntVector2::ZERO, layout);
+
+    //Add random tiles
+    while (static_cast<int>(layout.tiles_.Size()) < size && !frontier_.Empty()) {
+
+        //Pick and remove a random frontier cell
+        const unsigned pick{ static_cast<unsigned>(layoutRandom_.Random(static_cast<int>(frontier_.Size()))) };
+        const IntVector2 coords{ frontier_[pick] };
+        frontier_[pick] = frontier_.Back();
+        frontier_.Pop();
+
+        if (grid_.HasTile(coords))
+            continue;
+
+        AddTile(coords, layout);
+
+        if (symmetrical_ && coords.x_ != 0)
+            AddTile(IntVector2(-coords.x_, coords.y_), layout);
+    }
+}
+
+void PlatformGenerator::Decorate(PlatformLayout& layout)
+{
+    layout.extras_.Clear();
+    layout.propCounts_.Clear();
+    layout.props_.Clear();
+
+    for (const IntVector2& coords : layout.tiles_) {
+
+        //Roll random tile addons
+        const int extraRandomizer{ decorationRandom_.Random(23) };
+        const unsigned firstProp{ layout.props_.Size() };
+        TileExtra extra{ TX_NONE };
+
+        //Dreamspire
+        if (extraRandomizer == 7) {
+            extra = TX_SPIRE;
+        }
+        //Ekelplitfs
+        else if (extraRandomizer < 7) {
+            const int totalImps{ decorationRandom_.Random(0, 2) };
+
+            for (int i{0}; i < totalImps; ++i)
+                layout.props_.Push(Vector3(-0.075f * totalImps + 0.15f * i, PLATFORM_HALF_THICKNESS, decorationRandom_.Random(-0.5f, 0.5f)));
+
+            if (totalImps)
+                extra = TX_IMPS;
+        }
+        //Fire
+        else if (extraRandomizer == 8) {
+            extra = TX_FIRE;
+        }
+        //Frop crops
+        else if (extraRandomizer > 8 && coords.y_ % 2 == 0) {
+            extra = TX_FROPS;
+
+            for (int i{0}; i < 4; ++i)
+                for (int j{0}; j < 3; ++j)
+                    layout.props_.Push(Vector3(-0.375f + i * 0.25f, PLATFORM_HALF_THICKNESS, -0.3f + j * 0.3f));
+
+            for (int i{0}; i < extraRandomizer - 8; ++i)
+                layout.props_.Push(Vector3(decorationRandom_.Random(-0.4f, 0.4f), PLATFORM_HALF_THICKNESS, decorationRandom_.Random(-0.4f, 0.4f)));
+        }
+
+        layout.extras_.Push(extra);
+        layout.propCounts_.Push(layout.props_.Size() - firstProp);
+    }
+}
+
+void PlatformGenerator::AddTile(const IntVector2& coords, PlatformLayout& layout)
+{
+    grid_.Set(GL_TILE, coords, true);
+    layout.tiles_.Push(coords);
+
+    if (symmetrical_ && Abs(coords.x_) % 2 == 1 && coords.y_ <= 0)
+        layout.buildings_.Push(B_ENGINE);
+    else
+        layout.buildings_.Push(B_EMPTY);
+
+    //Empty neighbours join the frontier. The slot layer marks cells already in it.
+    //Symmetrical shapes only grow the positive half, the other half is mirrored.
+    for (int n{0}; n < NB_LENGTH; ++n) {
+
+        const IntVector2 neighbourCoords{ Platform::GetNeighbourCoords(coords, static_cast<Neighbour>(n)) };
+
+        if ((!symmetrical_ || neighbourCoords.x_ >= 0)
+         && !grid_.HasTile(neighbourCoords)
+         && !grid_.HasSlot(neighbourCoords))
+        {
+            grid_.Set(GL_SLOT, neighbourCoords, true);
+            frontier_.Push(neighbourCoords);
+        }
+    }
+}
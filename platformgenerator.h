@@ -0,0 +1,64 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef PLATFORMGENERATOR_H
+#define PLATFORMGENERATOR_H
+
+#include <Urho3D/Urho3D.h>
+
+#include "occupancygrid.h"
+#include "platform.h"
+#include "randomstream.h"
+
+//Plain data description of a platform, safe to build off the main thread
+struct PlatformLayout
+{
+    unsigned seed_;
+
+    PODVector<IntVector2> tiles_;
+    //Building type per tile, as stored in the occupancy grid
+    PODVector<unsigned char> buildings_;
+    //TileExtra per tile
+    PODVector<unsigned char> extras_;
+    //Positions of imps or frops, grouped by tile
+    PODVector<unsigned char> propCounts_;
+    PODVector<Vector3> props_;
+};
+
+//Grows a platform shape by picking random cells from the set of empty
+//cells bordering it, which keeps generation linear in the tile count.
+class PlatformGenerator
+{
+public:
+    PlatformGenerator(unsigned seed, bool symmetrical = true);
+
+    int RollSize();
+    void Generate(int size, PlatformLayout& layout);
+    void Decorate(PlatformLayout& layout);
+
+private:
+    RandomStream layoutRandom_;
+    RandomStream decorationRandom_;
+    bool symmetrical_;
+    OccupancyGrid grid_;
+    PODVector<IntVector2> frontier_;
+
+    void AddTile(const IntVector2& coords, PlatformLayout& layout);
+};
+
+#endif // PLATFORMGENERATOR_H
@@ -0,0 +1,83 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "propulsion.h"
+
+void Propulsion::RegisterObject(Context* context)
+{
+    context->RegisterFactory<Propulsion>();
+}
+
+Propulsion::Propulsion(Context* context) : LogicComponent(context),
+    rigidBody_{},
+    numEngines_{0},
+    offsetSum_{},
+    throttle_{0.0f}
+{
+    //Only pushed by the physics step while engines are running
+    SetUpdateEventMask(0);
+}
+
+void Propulsion::OnNodeSet(Node* node)
+{ if (!node) return;
+
+    rigidBody_ = node_->GetComponent<RigidBody>();
+}
+
+void Propulsion::AddEngine(const Vector3& offset)
+{
+    ++numEngines_;
+    offsetSum_ += offset;
+    UpdateEventMask();
+}
+
+void Propulsion::RemoveEngine(const Vector3& offset)
+{
+    if (!numEngines_)
+        return;
+
+    --numEngines_;
+    offsetSum_ -= offset;
+    UpdateEventMask();
+}
+
+void Propulsion::SetThrottle(float throttle)
+{
+    throttle_ = Clamp(throttle, -1.0f, 1.0f);
+    UpdateEventMask();
+}
+
+void Propulsion::UpdateEventMask()
+{
+    SetUpdateEventMask(numEngines_ && throttle_ != 0.0f ? USE_FIXEDUPDATE : 0);
+}
+
+void Propulsion::FixedUpdate(float timeStep)
+{
+    if (!rigidBody_)
+        return;
+
+    //Net force and its moment around the center of mass, in platform space.
+    //The body's center includes the node's scale, engine offsets do not.
+    const Vector3 force{ Vector3::FORWARD * ENGINE_THRUST * throttle_ * timeStep * numEngines_ };
+    const Vector3 arm{ offsetSum_ / numEngines_ * node_->GetWorldScale() - rigidBody_->GetCenterOfMass() };
+
+    const Quaternion rotation{ node_->GetWorldRotation() };
+    rigidBody_->ApplyForce(rotation * force);
+    rigidBody_->ApplyTorque(rotation * arm.CrossProduct(force));
+}
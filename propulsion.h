@@ -0,0 +1,55 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef PROPULSION_H
+#define PROPULSION_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+
+#define ENGINE_THRUST 5000.0f
+
+//Drives a platform with all of its engines at once. Engines all push along
+//the platform's forward axis, so their net force and torque only depend on
+//the engine count and the sum of their offsets, which change with buildings.
+class Propulsion : public LogicComponent
+{
+    URHO3D_OBJECT(Propulsion, LogicComponent);
+public:
+    Propulsion(Context* context);
+    static void RegisterObject(Context* context);
+    virtual void OnNodeSet(Node* node);
+    virtual void FixedUpdate(float timeStep);
+
+    void AddEngine(const Vector3& offset);
+    void RemoveEngine(const Vector3& offset);
+    unsigned GetNumEngines() const { return numEngines_; }
+
+    void SetThrottle(float throttle);
+    float GetThrottle() const { return throttle_; }
+
+private:
+    RigidBody* rigidBody_;
+    unsigned numEngines_;
+    Vector3 offsetSum_;
+    float throttle_;
+
+    void UpdateEventMask();
+};
+
+#endif // PROPULSION_H
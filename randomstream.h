@@ -0,0 +1,86 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+
+//Independent sequences derived from one seed, so that adding draws to one
+//system never shifts the results of another
+enum RandomChannel { RC_LAYOUT = 1, RC_DECORATION, RC_PLACEMENT, RC_EDITS, RC_FROPS, RC_IMPS };
+
+//Self-contained xoshiro128** generator. Unlike Urho's Random() it holds its
+//own state, so it can be used from worker threads.
+class RandomStream
+{
+public:
+    RandomStream(unsigned seed = 0) { Seed(seed); }
+
+    //Combines a seed with a key into a new seed
+    static unsigned Derive(unsigned seed, unsigned key)
+    {
+        unsigned h{ seed ^ (key * 0x9e3779b9u) };
+        h = (h ^ (h >> 16)) * 0x7feb352du;
+        h = (h ^ (h >> 15)) * 0x846ca68bu;
+        return h ^ (h >> 16);
+    }
+
+    void Seed(unsigned seed)
+    {
+        //Expand the seed with splitmix32 so similar seeds give unrelated states
+        for (int i{0}; i < 4; ++i) {
+
+            seed += 0x9e3779b9u;
+            unsigned z{ seed };
+            z = (z ^ (z >> 16)) * 0x85ebca6bu;
+            z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+            state_[i] = z ^ (z >> 16);
+        }
+    }
+
+    unsigned Next()
+    {
+        const unsigned result{ RotateLeft(state_[1] * 5u, 7) * 9u };
+        const unsigned t{ state_[1] << 9 };
+
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = RotateLeft(state_[3], 11);
+
+        return result;
+    }
+
+    //Same ranges as Urho's Random functions
+    float Random() { return (Next() >> 8) * (1.0f / 16777216.0f); }
+    float Random(float range) { return Random() * range; }
+    float Random(float min, float max) { return min + Random() * (max - min); }
+    int Random(int range) { return static_cast<int>((static_cast<unsigned long long>(Next()) * static_cast<unsigned>(Max(range, 0))) >> 32); }
+    int Random(int min, int max) { return min + Random(max - min); }
+
+private:
+    static unsigned RotateLeft(unsigned x, int k) { return (x << k) | (x >> (32 - k)); }
+
+    unsigned state_[4];
+};
+
+#endif // RANDOMSTREAM_H
@@ -1,42 +1,46 @@
 
+#include "audiomaster.h"
+
 #include "sceneobject.h"
 
 SceneObject::SceneObject(Context *context):
     LogicComponent(context),
-    randomizer_{Random()}
+    randomizer_{Random()},
+    pooled_{false}
 {
+    //Objects that need updates ask for them, or register with the UpdateMaster
+    SetUpdateEventMask(0);
 }
 
 void SceneObject::OnNodeSet(Node *node)
 { if (!node) return;
-
-    for (int i{0}; i < 3; ++i){
-        sampleSources_.Push(node_->CreateComponent<SoundSource3D>());
-        sampleSources_[i]->SetGain(0.3f);
-        sampleSources_[i]->SetSoundType(SOUND_EFFECT);
-    }
 }
 
 void SceneObject::Set(Vector3 position)
 {
     node_->SetPosition(position);
-    node_->SetEnabledRecursive(true);
+    //Children may be left over from a previous use or be pooled objects, so they stay as they are
+    node_->SetEnabled(true);
 }
 
 void SceneObject::Disable()
 {
+    //Pooled objects below this one go dark along with it, so return them too
+    PODVector<SceneObject*> objects{};
+    node_->GetDerivedComponents<SceneObject>(objects, true);
+
     node_->SetEnabledRecursive(false);
+
+    for (SceneObject* object : objects)
+        SPAWN->Release(object);
+    //Objects may draw through a node other than the one holding them
+    SPAWN->Release(this);
 }
 
-void SceneObject::PlaySample(Sound* sample, float gain)
+void SceneObject::PlaySample(Sound* sample, float gain, int priority)
 {
-    for (SoundSource3D* s : sampleSources_){
-        if (!s->IsPlaying()){
-            s->SetGain(gain);
-            s->Play(sample);
-            break;
-        }
-    }
+    //Voices are shared and only follow the node while playing
+    GetSubsystem<AudioMaster>()->Play(sample, node_, gain, priority);
 }
 
 Vector3 SceneObject::GetWorldPosition() const
@@ -10,6 +10,7 @@
 
 class SceneObject : public LogicComponent
 {
+    friend class SpawnMaster;
     URHO3D_OBJECT(SceneObject, LogicComponent);
 public:
     SceneObject(Context* context);
@@ -20,11 +21,12 @@ public:
 
     Vector3 GetWorldPosition() const;
 protected:
-    Vector<SoundSource3D*> sampleSources_;
     float randomizer_;
 
 
-    void PlaySample(Sound *sample, float gain = 0.3f);
+    void PlaySample(Sound *sample, float gain = 0.3f, int priority = 0);
+private:
+    bool pooled_;
 };
 
 #endif // SCENEOBJECT_H
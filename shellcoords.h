@@ -0,0 +1,57 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SHELLCOORDS_H
+#define SHELLCOORDS_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+
+#define NUM_SHELL_FACES 30
+
+//Edges of a rhombic face, named by the quadrant of the face plane they bound.
+//Corners lie on the diagonals, so each edge sits in one quadrant.
+enum ShellEdge { SE_POSITIVE_UV = 0, SE_NEGATIVE_U, SE_NEGATIVE_UV, SE_NEGATIVE_V, SE_LENGTH };
+
+//Position relative to the world's shell: the rhombic face it belongs to,
+//coordinates along that face's long (u) and short (v) diagonals measured
+//from its center, and the height above the face plane.
+struct ShellCoords
+{
+    ShellCoords(int face = 0, const Vector2& uv = Vector2::ZERO, float height = 0.0f):
+        face_{face},
+        uv_{uv},
+        height_{height}
+    {
+    }
+
+    //Edge of the face nearest to the coordinates
+    ShellEdge GetEdge() const
+    {
+        if (uv_.y_ >= 0.0f)
+            return uv_.x_ >= 0.0f ? SE_POSITIVE_UV : SE_NEGATIVE_U;
+        else
+            return uv_.x_ < 0.0f ? SE_NEGATIVE_UV : SE_NEGATIVE_V;
+    }
+
+    int face_;
+    Vector2 uv_;
+    float height_;
+};
+
+#endif // SHELLCOORDS_H
@@ -0,0 +1,173 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
+#include "platform.h"
+#include "world.h"
+#include "shellindex.h"
+
+#include "shelldynamics.h"
+
+void ShellDynamics::RegisterObject(Context* context)
+{
+    context->RegisterFactory<ShellDynamics>();
+}
+
+ShellDynamics::ShellDynamics(Context* context) : LogicComponent(context),
+    platforms_{},
+    positionX_{},
+    positionY_{},
+    positionZ_{},
+    height_{},
+    face_{},
+    springX_{},
+    springY_{},
+    springZ_{},
+    active_{},
+    gravity_{}
+{
+    SetUpdateEventMask(USE_UPDATE);
+}
+
+void ShellDynamics::AddPlatform(Platform* platform)
+{
+    platforms_.Push(WeakPtr<Platform>(platform));
+    gravity_.Push(Vector3::ZERO);
+}
+
+void ShellDynamics::Update(float timeStep)
+{
+    //Drop removed platforms
+    for (unsigned p{0}; p < platforms_.Size(); ) {
+
+        if (platforms_[p].Expired()) {
+            platforms_.EraseSwap(p);
+            gravity_.EraseSwap(p);
+        } else {
+            ++p;
+        }
+    }
+
+    World* world{ GetScene()->GetComponent<World>() };
+    if (platforms_.Empty() || !world->GetNumFaces())
+        return;
+
+    //Pooled platforms keep their entry but sit out until they are set again
+    active_.Clear();
+    for (unsigned p{0}; p < platforms_.Size(); ++p) {
+
+        if (platforms_[p]->IsEnabledEffective())
+            active_.Push(p);
+    }
+
+    const unsigned count{ active_.Size() };
+    if (!count)
+        return;
+
+    //Gather positions
+    positionX_.Resize(count);
+    positionY_.Resize(count);
+    positionZ_.Resize(count);
+    height_.Resize(count);
+    face_.Resize(count);
+    springX_.Resize(count);
+    springY_.Resize(count);
+    springZ_.Resize(count);
+
+    for (unsigned a{0}; a < count; ++a) {
+
+        const Vector3 position{ platforms_[active_[a]]->GetNode()->GetWorldPosition() };
+        positionX_[a] = position.x_;
+        positionY_[a] = position.y_;
+        positionZ_[a] = position.z_;
+    }
+
+    world->GetFaces(positionX_.Buffer(), positionY_.Buffer(), positionZ_.Buffer(), count,
+                    face_.Buffer(), height_.Buffer());
+
+    //The spatial index is placed from the faces found here instead of finding them again
+    ShellIndex* index{ GetScene()->GetComponent<ShellIndex>() };
+
+    //Spring towards the face plane, starting from the face normals
+    for (unsigned a{0}; a < count; ++a) {
+
+        const int face{ face_[a] };
+        const Vector3 offset{ Vector3(positionX_[a], positionY_[a], positionZ_[a]) - world->GetFaceCenter(face) };
+        index->Place(platforms_[active_[a]]->GetNode(), face, Vector2(offset.DotProduct(world->GetFaceAxisU(face)),
+                                                                      offset.DotProduct(world->GetFaceAxisV(face))));
+
+        const Vector3& normal{ world->GetFaceNormal(face) };
+        springX_[a] = normal.x_;
+        springY_[a] = normal.y_;
+        springZ_[a] = normal.z_;
+    }
+
+    Spring(count, world->GetRadius());
+
+    //Written back only when it changed
+    for (unsigned a{0}; a < count; ++a) {
+
+        const unsigned p{ active_[a] };
+        Platform* platform{ platforms_[p] };
+        const Vector3 gravity{ springX_[a], springY_[a], springZ_[a] };
+
+        if (!gravity.Equals(gravity_[p])) {
+
+            gravity_[p] = gravity;
+            platform->rigidBody_->SetGravityOverride(gravity);
+        }
+
+        if (platform->rigidBody_->IsActive())
+            platform->Realign(timeStep, world->GetFaceNormal(face_[a]));
+    }
+}
+
+void ShellDynamics::Spring(unsigned count, float radius)
+{
+    unsigned a{ 0 };
+
+#ifdef URHO3D_SSE
+    //Four platforms at a time
+    const __m128 shell{ _mm_set1_ps(radius) };
+    const __m128 stiffness{ _mm_set1_ps(-SHELL_STIFFNESS) };
+    const __m128 sign{ _mm_set1_ps(-0.0f) };
+
+    for (; a + 4 <= count; a += 4) {
+
+        const __m128 out{ _mm_sub_ps(_mm_loadu_ps(&height_[a]), shell) };
+        const __m128 strength{ _mm_mul_ps(stiffness, _mm_mul_ps(out, _mm_andnot_ps(sign, out))) };
+
+        _mm_storeu_ps(&springX_[a], _mm_mul_ps(strength, _mm_loadu_ps(&springX_[a])));
+        _mm_storeu_ps(&springY_[a], _mm_mul_ps(strength, _mm_loadu_ps(&springY_[a])));
+        _mm_storeu_ps(&springZ_[a], _mm_mul_ps(strength, _mm_loadu_ps(&springZ_[a])));
+    }
+#endif
+
+    for (; a < count; ++a) {
+
+        const float out{ height_[a] - radius };
+        const float strength{ -SHELL_STIFFNESS * out * Abs(out) };
+
+        springX_[a] *= strength;
+        springY_[a] *= strength;
+        springZ_[a] *= strength;
+    }
+}
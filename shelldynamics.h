@@ -0,0 +1,65 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SHELLDYNAMICS_H
+#define SHELLDYNAMICS_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+
+//Gravity towards the shell grows with the square of the distance from it
+#define SHELL_STIFFNESS 23.0f
+
+class Platform;
+
+//Keeps all platforms on the world's shell in one batched pass per frame.
+//Positions are gathered into arrays so the nearest face search runs over
+//all platforms at once, and only changed gravity overrides are written back.
+class ShellDynamics : public LogicComponent
+{
+    URHO3D_OBJECT(ShellDynamics, LogicComponent);
+public:
+    ShellDynamics(Context* context);
+    static void RegisterObject(Context* context);
+    virtual void Update(float timeStep);
+
+    void AddPlatform(Platform* platform);
+
+private:
+    Vector<WeakPtr<Platform> > platforms_;
+
+    //Per enabled platform
+    PODVector<float> positionX_;
+    PODVector<float> positionY_;
+    PODVector<float> positionZ_;
+    PODVector<float> height_;
+    PODVector<int> face_;
+    PODVector<float> springX_;
+    PODVector<float> springY_;
+    PODVector<float> springZ_;
+    //Indices of the enabled platforms
+    PODVector<unsigned> active_;
+
+    //Per platform
+    PODVector<Vector3> gravity_;
+
+    //Scales the gathered face normals by the spring strength at each height
+    void Spring(unsigned count, float radius);
+};
+
+#endif // SHELLDYNAMICS_H
@@ -0,0 +1,217 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "world.h"
+
+#include "shellindex.h"
+
+void ShellIndex::RegisterObject(Context* context)
+{
+    context->RegisterFactory<ShellIndex>();
+}
+
+ShellIndex::ShellIndex(Context* context) : LogicComponent(context),
+    world_{},
+    entries_{},
+    buckets_{},
+    cells_{},
+    maxRadius_{0.0f}
+{
+    SetUpdateEventMask(USE_UPDATE);
+}
+
+bool ShellIndex::Prepare()
+{
+    if (!buckets_.Empty())
+        return true;
+
+    world_ = GetScene()->GetComponent<World>();
+    if (!world_ || !world_->GetNumFaces())
+        return false;
+
+    const Vector2 halfDiagonals{ world_->GetHalfDiagonals() };
+    cells_ = IntVector2(CeilToInt(2.0f * halfDiagonals.x_ / SHELL_CELL_SIZE),
+                        CeilToInt(2.0f * halfDiagonals.y_ / SHELL_CELL_SIZE));
+    buckets_.Resize(world_->GetNumFaces() * cells_.x_ * cells_.y_);
+
+    return true;
+}
+
+IntVector2 ShellIndex::CellOf(const Vector2& uv) const
+{
+    //Clamped, so positions slightly past an edge stay in their face
+    const Vector2 halfDiagonals{ world_->GetHalfDiagonals() };
+
+    return IntVector2(Clamp(FloorToInt((uv.x_ + halfDiagonals.x_) / SHELL_CELL_SIZE), 0, cells_.x_ - 1),
+                      Clamp(FloorToInt((uv.y_ + halfDiagonals.y_) / SHELL_CELL_SIZE), 0, cells_.y_ - 1));
+}
+
+unsigned ShellIndex::BucketOf(const ShellCoords& coords) const
+{
+    const IntVector2 cell{ CellOf(coords.uv_) };
+    return (coords.face_ * cells_.y_ + cell.y_) * cells_.x_ + cell.x_;
+}
+
+template <class F> void ShellIndex::VisitCells(int face, const IntVector2& min, const IntVector2& max, StringHash type, F visit) const
+{
+    for (int y{min.y_}; y <= max.y_; ++y) {
+        for (int x{min.x_}; x <= max.x_; ++x) {
+
+            for (unsigned id : buckets_[(face * cells_.y_ + y) * cells_.x_ + x]) {
+
+                const Entry& entry{ entries_.Find(id)->second_ };
+                Node* node{ entry.node_.Get() };
+
+                if (node && node->IsEnabled() && (type == StringHash::ZERO || entry.type_ == type))
+                    visit(node, entry.radius_);
+            }
+        }
+    }
+}
+
+void ShellIndex::Insert(Node* node, StringHash type, float radius)
+{
+    if (!node || !Prepare())
+        return;
+
+    Remove(node);
+
+    const unsigned bucket{ BucketOf(world_->ToShell(node->GetWorldPosition())) };
+    entries_[node->GetID()] = Entry{ WeakPtr<Node>(node), type, bucket, radius };
+    buckets_[bucket].Push(node->GetID());
+    maxRadius_ = Max(maxRadius_, radius);
+}
+
+void ShellIndex::Remove(Node* node)
+{
+    HashMap<unsigned, Entry>::Iterator e{ entries_.Find(node->GetID()) };
+    if (e == entries_.End())
+        return;
+
+    buckets_[e->second_.bucket_].RemoveSwap(e->first_);
+    entries_.Erase(e);
+}
+
+void ShellIndex::Place(Node* node, int face, const Vector2& uv)
+{
+    HashMap<unsigned, Entry>::Iterator e{ entries_.Find(node->GetID()) };
+    if (e == entries_.End())
+        return;
+
+    Entry& entry{ e->second_ };
+    const unsigned bucket{ BucketOf(ShellCoords(face, uv, 0.0f)) };
+
+    if (bucket != entry.bucket_) {
+
+        buckets_[entry.bucket_].RemoveSwap(e->first_);
+        buckets_[bucket].Push(e->first_);
+        entry.bucket_ = bucket;
+    }
+}
+
+void ShellIndex::SetRadius(Node* node, float radius)
+{
+    HashMap<unsigned, Entry>::Iterator e{ entries_.Find(node->GetID()) };
+    if (e == entries_.End())
+        return;
+
+    e->second_.radius_ = radius;
+    maxRadius_ = Max(maxRadius_, radius);
+}
+
+void ShellIndex::Update(float timeStep)
+{ (void)timeStep;
+
+    //Drop removed nodes
+    for (HashMap<unsigned, Entry>::Iterator e{ entries_.Begin() }; e != entries_.End(); ) {
+
+        if (!e->second_.node_) {
+
+            buckets_[e->second_.bucket_].RemoveSwap(e->first_);
+            e = entries_.Erase(e);
+
+        } else {
+
+            ++e;
+        }
+    }
+}
+
+void ShellIndex::QueryFace(PODVector<Node*>& result, int face, StringHash type) const
+{
+    if (buckets_.Empty())
+        return;
+
+    VisitCells(face, IntVector2::ZERO, cells_ - IntVector2(1, 1), type,
+               [&result](Node* node, float) { result.Push(node); });
+}
+
+void ShellIndex::QueryRadius(PODVector<Node*>& result, const Vector3& center, float radius, StringHash type) const
+{
+    if (buckets_.Empty())
+        return;
+
+    const Vector2 halfDiagonals{ world_->GetHalfDiagonals() };
+    //Nodes count as in range when their own radius overlaps
+    const float reach{ radius + maxRadius_ };
+
+    for (unsigned f{0}; f < world_->GetNumFaces(); ++f) {
+
+        //Projecting onto the face plane never increases distances, so nodes
+        //within range lie in the cells around the projected center
+        const Vector3 offset{ center - world_->GetFaceCenter(f) };
+        const Vector2 uv{ offset.DotProduct(world_->GetFaceAxisU(f)),
+                          offset.DotProduct(world_->GetFaceAxisV(f)) };
+
+        if (Abs(uv.x_) - reach > halfDiagonals.x_ || Abs(uv.y_) - reach > halfDiagonals.y_)
+            continue;
+
+        VisitCells(f, CellOf(uv - Vector2::ONE * reach), CellOf(uv + Vector2::ONE * reach), type,
+                   [&](Node* node, float nodeRadius) {
+            if ((node->GetWorldPosition() - center).LengthSquared() <= (radius + nodeRadius) * (radius + nodeRadius))
+                result.Push(node);
+        });
+    }
+}
+
+void ShellIndex::QueryCone(PODVector<Node*>& result, const Vector3& axis, float angle, StringHash type) const
+{
+    if (buckets_.Empty())
+        return;
+
+    const Vector3 direction{ axis.Normalized() };
+    //Angle from a face's center to its farthest corner, widened by the largest node
+    const float faceAngle{ Atan((world_->GetHalfDiagonals().x_ + maxRadius_) / world_->GetRadius()) };
+
+    for (unsigned f{0}; f < world_->GetNumFaces(); ++f) {
+
+        if (world_->GetFaceNormal(f).Angle(direction) > angle + faceAngle)
+            continue;
+
+        VisitCells(f, IntVector2::ZERO, cells_ - IntVector2(1, 1), type,
+                   [&](Node* node, float nodeRadius) {
+            const Vector3 position{ node->GetWorldPosition() };
+            const float distance{ position.Length() };
+            //Angle the node's radius subtends around its position
+            const float spread{ distance > nodeRadius ? Asin(nodeRadius / distance) : 180.0f };
+
+            if (position.Angle(direction) <= angle + spread)
+                result.Push(node);
+        });
+    }
+}
@@ -0,0 +1,79 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SHELLINDEX_H
+#define SHELLINDEX_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+#include "shellcoords.h"
+
+#define SHELL_CELL_SIZE 16.0f
+
+class World;
+
+//Buckets nodes on the world's shell by rhombic face and by a grid cell
+//within that face, so spatial queries only visit nearby buckets.
+class ShellIndex : public LogicComponent
+{
+    URHO3D_OBJECT(ShellIndex, LogicComponent);
+public:
+    ShellIndex(Context* context);
+    static void RegisterObject(Context* context);
+    virtual void Update(float timeStep);
+
+    //Nodes are bucketed where they are when added. The radius is how far their
+    //content reaches from the node, so queries find them by their extent.
+    void Insert(Node* node, StringHash type, float radius = 0.0f);
+    void Remove(Node* node);
+    //Rebuckets a moving node from shell coordinates its owner already has
+    void Place(Node* node, int face, const Vector2& uv);
+    void SetRadius(Node* node, float radius);
+
+    //Results are appended; a zero type matches every node. Disabled nodes are left out.
+    void QueryFace(PODVector<Node*>& result, int face, StringHash type = StringHash::ZERO) const;
+    void QueryRadius(PODVector<Node*>& result, const Vector3& center, float radius, StringHash type = StringHash::ZERO) const;
+    //Nodes within an angle of an axis through the core
+    void QueryCone(PODVector<Node*>& result, const Vector3& axis, float angle, StringHash type = StringHash::ZERO) const;
+
+private:
+    struct Entry
+    {
+        WeakPtr<Node> node_;
+        StringHash type_;
+        unsigned bucket_;
+        float radius_;
+    };
+
+    bool Prepare();
+    unsigned BucketOf(const ShellCoords& coords) const;
+    IntVector2 CellOf(const Vector2& uv) const;
+    //Visits the live nodes of matching type in a range of cells of one face
+    template <class F> void VisitCells(int face, const IntVector2& min, const IntVector2& max, StringHash type, F visit) const;
+
+    WeakPtr<World> world_;
+    //Keyed by node ID, which buckets hold so removed nodes are never dereferenced
+    HashMap<unsigned, Entry> entries_;
+    Vector<PODVector<unsigned> > buckets_;
+    //Cells per face along the long and short diagonals
+    IntVector2 cells_;
+    //Largest radius ever set, which widens the cells a query visits
+    float maxRadius_;
+};
+
+#endif // SHELLINDEX_H
@@ -42,13 +42,6 @@ void Slot::OnNodeSet(Node *node)
     model->SetModel(RESOURCE->GetModel("Slot"));
     model->SetMaterial(RESOURCE->GetMaterial("Glow"));
     model->SetCastShadows(false);*/
-    StaticModel* hitModel{ node_->CreateComponent<StaticModel>() };
-    hitModel->SetModel(RESOURCE->GetModel("SlotHitPlane"));
-    hitModel->SetMaterial(RESOURCE->GetMaterial("Invisible"));
-
-    cursor_ = MC->world.cursor.sceneCursor;
-
-    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(Slot, HandleUpdate));
 }
 
 void Slot::Set(IntVector2 coords, Platform* platform)
@@ -68,17 +61,3 @@ void Slot::Start()
 void Slot::Stop()
 {
 }
-
-void Slot::HandleUpdate(StringHash eventType, VariantMap &eventData)
-{
-    //using namespace Update; double timeStep = eventData[P_TIMESTEP].GetFloat();
-
-    //double elapsedTime = platform_->masterControl_->world.scene_->GetElapsedTime();
-    //rootNode_->SetScale(Vector3(1.0f+(0.1f*sinf(2.0f*elapsedTime)),1.0f+(0.1f*sinf(10.0f*elapsedTime)),1.0f+(0.1f*sinf(6.0f*elapsedTime))));
-
-    float cursorDist = Max(0.0f, (node_->GetWorldPosition() - cursor_->GetPosition()).Length() - 2.0f);
-    float scale = Clamp(1.0f - (0.1f * cursorDist), 0.0f, 1.0f);
-    for (int i = 0; i < 3; i ++) scale *= scale;
-    node_->SetScale(scale);
-    //model_->GetMaterial()->SetShaderParameter("MatDiffColor", Color(0.125f, 1.0f, 1.0f, 0.7f));
-}
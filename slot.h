@@ -49,10 +49,8 @@ public:
 
     Platform* GetPlatform() const { return platform_; }
 private:
-    void HandleUpdate(StringHash eventType, VariantMap& eventData);
     Platform* platform_;
     //StaticModel* model_;
-    Node* cursor_;
 };
 
 #endif // SLOT_H
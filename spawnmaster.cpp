@@ -1,8 +1,14 @@
 
+#include "sceneobject.h"
+
 #include "spawnmaster.h"
 
 SpawnMaster::SpawnMaster(Context* context):
-    Object(context)
+    Object(context),
+    pools_{},
+    activeCounts_{},
+    prewarmOrders_{},
+    prewarmBudget_{2.0f}
 {
 }
 
@@ -16,6 +22,9 @@ void SpawnMaster::Deactivate()
 }
 void SpawnMaster::Clear()
 {
+    pools_.Clear();
+    activeCounts_.Clear();
+    prewarmOrders_.Clear();
 }
 
 void SpawnMaster::Restart()
@@ -24,9 +33,94 @@ void SpawnMaster::Restart()
     Activate();
 }
 
+SceneObject* SpawnMaster::Acquire(StringHash type)
+{
+    HashMap<StringHash, PODVector<SceneObject*> >::Iterator pool{ pools_.Find(type) };
+
+    if (pool == pools_.End() || pool->second_.Empty())
+        return nullptr;
+
+    SceneObject* object{ pool->second_.Back() };
+    pool->second_.Pop();
+    object->pooled_ = false;
+
+    return object;
+}
+
+SceneObject* SpawnMaster::Instantiate(StringHash type)
+{
+    Node* spawnedNode{ MC->GetScene()->CreateChild(type.ToString()) };
+    SceneObject* created{ static_cast<SceneObject*>(spawnedNode->CreateComponent(type)) };
+    spawnedNode->SetEnabledRecursive(false);
+
+    return created;
+}
+
+void SpawnMaster::Prewarm(StringHash type, unsigned count)
+{
+    if (!count)
+        return;
+
+    for (PrewarmOrder& order : prewarmOrders_) {
+
+        if (order.type_ == type) {
+            order.remaining_ += count;
+            return;
+        }
+    }
+
+    prewarmOrders_.Push({ type, count });
+
+    if (!HasSubscribedToEvent(E_SCENEUPDATE))
+        Activate();
+}
+
+void SpawnMaster::HandlePrewarm()
+{
+    //Instantiate pooled objects until this frame's budget is spent
+    HiresTimer timer{};
+    const long long budget{ static_cast<long long>(prewarmBudget_ * 1000.0f) };
+
+    while (!prewarmOrders_.Empty() && timer.GetUSec(false) < budget) {
+
+        PrewarmOrder& order{ prewarmOrders_.Front() };
+        SceneObject* created{ Instantiate(order.type_) };
+        created->pooled_ = true;
+        pools_[order.type_].Push(created);
+
+        if (--order.remaining_ == 0)
+            prewarmOrders_.Erase(0);
+    }
+}
+
+void SpawnMaster::Release(SceneObject* object)
+{
+    if (!object || object->pooled_)
+        return;
+
+    object->pooled_ = true;
+    pools_[object->GetType()].Push(object);
+
+    HashMap<StringHash, int>::Iterator count{ activeCounts_.Find(object->GetType()) };
+    if (count != activeCounts_.End() && count->second_ > 0)
+        --count->second_;
+}
+
+int SpawnMaster::CountActive(StringHash type) const
+{
+    HashMap<StringHash, int>::ConstIterator count{ activeCounts_.Find(type) };
+
+    if (count != activeCounts_.End())
+        return count->second_;
+    else
+        return 0;
+}
+
 void SpawnMaster::HandleSceneUpdate(StringHash eventType, VariantMap &eventData)
 { (void)eventType;
 
     const float timeStep{ eventData[SceneUpdate::P_TIMESTEP].GetFloat() };
-}
 
+    if (IsPrewarming())
+        HandlePrewarm();
+}
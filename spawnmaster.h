@@ -6,6 +6,8 @@
 
 #include "mastercontrol.h"
 
+class SceneObject;
+
 class SpawnMaster : public Object
 {
     friend class MasterControl;
@@ -19,41 +21,45 @@ public:
     {
         T* created{ nullptr };
 
-        if (recycle) {
-            PODVector<Node*> correctType{};
-            MC->GetScene()->GetChildrenWithComponent<T>(correctType);
-            for (Node* n : correctType) {
+        if (recycle)
+            created = static_cast<T*>(Acquire(T::GetTypeStatic()));
 
-                if (!n->IsEnabled()) {
-                    created = n->GetComponent<T>();
-                    break;
-                }
-            }
-        }
-        if(!created) {
+        if (!created)
+            created = static_cast<T*>(Instantiate(T::GetTypeStatic()));
 
-            Node* spawnedNode{ MC->GetScene()->CreateChild(T::GetTypeStatic().ToString()) };
-            created = spawnedNode->CreateComponent<T>();
-            spawnedNode->SetEnabledRecursive(false);
-        }
+        ++activeCounts_[T::GetTypeStatic()];
 
         return created;
     }
 
-    template <class T> int CountActive()
-    {
-        int count{0};
-        PODVector<Node*> result{};
-        MC->GetScene()->GetChildrenWithComponent<T>(result);
+    template <class T> int CountActive() const { return CountActive(T::GetTypeStatic()); }
+    int CountActive(StringHash type) const;
 
-        for (Node* r : result) {
+    void Release(SceneObject* object);
 
-            if (r->IsEnabled()) ++count;
-        }
-        return count;
-    }
+    template <class T> void Prewarm(unsigned count) { Prewarm(T::GetTypeStatic(), count); }
+    void Prewarm(StringHash type, unsigned count);
+    void SetPrewarmBudget(float milliseconds) { prewarmBudget_ = milliseconds; }
+    bool IsPrewarming() const { return !prewarmOrders_.Empty(); }
 
 private:
+    struct PrewarmOrder
+    {
+        StringHash type_;
+        unsigned remaining_;
+    };
+
+    //Disabled objects per type, ready to be handed out again
+    HashMap<StringHash, PODVector<SceneObject*> > pools_;
+    HashMap<StringHash, int> activeCounts_;
+
+    PODVector<PrewarmOrder> prewarmOrders_;
+    float prewarmBudget_;
+
+    SceneObject* Acquire(StringHash type);
+    SceneObject* Instantiate(StringHash type);
+    void HandlePrewarm();
+
     void Activate();
     void Deactivate();
     void Restart();
@@ -62,4 +68,3 @@ private:
 };
 
 #endif // SPAWNMASTER_H
-
@@ -18,6 +18,9 @@
 
 
 #include "world.h"
+#include "shellindex.h"
+#include "platform.h"
+#include "tile.h"
 
 #include "storm.h"
 
@@ -28,6 +31,7 @@ void Storm::RegisterObject(Context* context)
 
 Storm::Storm(Context* context) : SceneObject(context)
 {
+    SetUpdateEventMask(USE_UPDATE);
 }
 
 void Storm::OnNodeSet(Node* node)
@@ -38,22 +42,33 @@ void Storm::Set(Vector3 position)
 {
     SceneObject::Set(position);
 
-    Vector3 rhombicCenter{ GetScene()->GetComponent<World>()->GetNearestRhombicCenter(node_->GetWorldPosition()) };
+    //Face the center of the nearest face, at the same height
+    World* world{ GetScene()->GetComponent<World>() };
+    const ShellCoords coords{ world->ToShell(node_->GetWorldPosition()) };
 
-    node_->LookAt(node_->GetWorldPosition() + (rhombicCenter - node_->GetWorldPosition().Normalized() * rhombicCenter.ProjectOntoAxis(node_->GetWorldPosition())),
+    node_->LookAt(world->FromShell(ShellCoords(coords.face_, Vector2::ZERO, coords.height_)),
                   node_->GetWorldPosition().Normalized());
 
     StaticModel* sphere{ node_->CreateComponent<StaticModel>() };
     sphere->SetModel(RESOURCE->GetModel("Sphere"));
+    sphere->SetViewMask(VM_SCENERY);
 
     node_->SetScale(Vector3(10.0f, 42.0f, 10.0f));
 
     node_->CreateComponent<RigidBody>();
     node_->CreateComponent<CollisionShape>()->SetSphere(1.0f);
+
+    GetScene()->GetComponent<ShellIndex>()->Insert(node_, GetType());
 }
 
 void Storm::Update(float timeStep)
 {
+    //The unit storm sphere has a diameter of one, so its radius is half the scale
+    PODVector<TileHit> hits{};
+    GetScene()->GetComponent<World>()->QueryTiles(hits, Sphere(node_->GetWorldPosition(), 0.5f * node_->GetWorldScale().x_));
+
+    for (const TileHit& hit : hits)
+        hit.platform_->GetTile(hit.coords_)->ApplyDamage(STORM_DAMAGE * timeStep);
 }
 
 
@@ -24,6 +24,9 @@
 #include <Urho3D/Urho3D.h>
 #include "sceneobject.h"
 
+//Health per second taken from tiles inside a storm
+#define STORM_DAMAGE 0.05f
+
 class Storm : public SceneObject
 {
     URHO3D_OBJECT(Storm, SceneObject);
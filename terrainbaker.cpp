@@ -0,0 +1,237 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "terrainbaker.h"
+
+HashMap<String, WeakPtr<Model> > TerrainBaker::loaded_{};
+unsigned TerrainBaker::storeCount_{0};
+
+TerrainBaker::TerrainBaker(Context* context):
+    context_{context},
+    elements_{},
+    vertexSize_{0},
+    vertexData_{},
+    indexData_{},
+    boundingBox_{}
+{
+}
+
+void TerrainBaker::AddPiece(Model* model, const Matrix3x4& transform)
+{
+    if (!model)
+        return;
+
+    const Matrix3 rotation{ transform.ToMatrix3() };
+
+    for (unsigned g{0}; g < model->GetNumGeometries(); ++g) {
+
+        Geometry* geometry{ model->GetGeometry(g, 0) };
+        if (!geometry)
+            continue;
+
+        const unsigned char* vertexData{};
+        const unsigned char* indexData{};
+        unsigned vertexSize{};
+        unsigned indexSize{};
+        const PODVector<VertexElement>* elements{};
+        geometry->GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+
+        if (!vertexData || !indexData || !elements)
+            continue;
+
+        //All pieces share one vertex layout
+        if (elements_.Empty()) {
+            elements_ = *elements;
+            vertexSize_ = vertexSize;
+        } else if (*elements != elements_) {
+            Log::Write(LOG_WARNING, "Skipped terrain piece with mismatching vertex layout: " + model->GetName());
+            continue;
+        }
+
+        const unsigned indexStart{ geometry->GetIndexStart() };
+        const unsigned indexCount{ geometry->GetIndexCount() };
+        const unsigned vertexStart{ geometry->GetVertexStart() };
+        const unsigned vertexCount{ geometry->GetVertexCount() };
+        const unsigned base{ vertexData_.Size() / vertexSize_ };
+
+        //Copy and transform vertices
+        vertexData_.Resize(vertexData_.Size() + vertexCount * vertexSize_);
+        unsigned char* dest{ &vertexData_[base * vertexSize_] };
+        memcpy(dest, vertexData + vertexStart * vertexSize_, vertexCount * vertexSize_);
+
+        for (const VertexElement& element : elements_) {
+
+            if (element.type_ != TYPE_VECTOR3 && element.type_ != TYPE_VECTOR4)
+                continue;
+
+            for (unsigned v{0}; v < vertexCount; ++v) {
+
+                Vector3& value{ *reinterpret_cast<Vector3*>(dest + v * vertexSize_ + element.offset_) };
+
+                switch (element.semantic_) {
+                case SEM_POSITION:
+                    value = transform * value;
+                    boundingBox_.Merge(value);
+                    break;
+                case SEM_NORMAL: case SEM_TANGENT:
+                    value = rotation * value;
+                    break;
+                default: break;
+                }
+            }
+        }
+
+        //Copy and rebase indices
+        for (unsigned i{indexStart}; i < indexStart + indexCount; ++i) {
+
+            const unsigned index{ indexSize == sizeof(unsigned)
+                        ? reinterpret_cast<const unsigned*>(indexData)[i]
+                        : reinterpret_cast<const unsigned short*>(indexData)[i] };
+
+            indexData_.Push(base + index - vertexStart);
+        }
+    }
+}
+
+SharedPtr<Model> TerrainBaker::Bake()
+{
+    if (IsEmpty())
+        return SharedPtr<Model>{};
+
+    const unsigned numVertices{ vertexData_.Size() / vertexSize_ };
+    const unsigned numIndices{ indexData_.Size() };
+    const bool largeIndices{ numVertices > 0xffff };
+
+    SharedPtr<VertexBuffer> vertexBuffer{ new VertexBuffer(context_) };
+    vertexBuffer->SetShadowed(true);
+    vertexBuffer->SetSize(numVertices, elements_);
+    vertexBuffer->SetData(vertexData_.Buffer());
+
+    SharedPtr<IndexBuffer> indexBuffer{ new IndexBuffer(context_) };
+    indexBuffer->SetShadowed(true);
+    indexBuffer->SetSize(numIndices, largeIndices);
+
+    if (largeIndices) {
+        indexBuffer->SetData(indexData_.Buffer());
+    } else {
+        PODVector<unsigned short> shortIndices(numIndices);
+        for (unsigned i{0}; i < numIndices; ++i)
+            shortIndices[i] = static_cast<unsigned short>(indexData_[i]);
+
+        indexBuffer->SetData(shortIndices.Buffer());
+    }
+
+    SharedPtr<Geometry> geometry{ new Geometry(context_) };
+    geometry->SetVertexBuffer(0, vertexBuffer);
+    geometry->SetIndexBuffer(indexBuffer);
+    geometry->SetDrawRange(TRIANGLE_LIST, 0, numIndices);
+
+    SharedPtr<Model> model{ new Model(context_) };
+    model->SetNumGeometries(1);
+    model->SetGeometry(0, 0, geometry);
+    model->SetBoundingBox(boundingBox_);
+
+    //Keep the buffer lists filled so the model can be saved
+    Vector<SharedPtr<VertexBuffer> > vertexBuffers{};
+    vertexBuffers.Push(vertexBuffer);
+    Vector<SharedPtr<IndexBuffer> > indexBuffers{};
+    indexBuffers.Push(indexBuffer);
+    model->SetVertexBuffers(vertexBuffers, PODVector<unsigned>(), PODVector<unsigned>());
+    model->SetIndexBuffers(indexBuffers);
+
+    return model;
+}
+
+String TerrainBaker::CacheDir(Context* context)
+{
+    return context->GetSubsystem<FileSystem>()->GetAppPreferencesDir("luckey", "oneiron") + "TerrainCache/";
+}
+
+String TerrainBaker::CachePath(Context* context, const String& key)
+{
+    return CacheDir(context) + key + ".mdl";
+}
+
+void TerrainBaker::TrimCache(Context* context)
+{
+    FileSystem* fileSystem{ context->GetSubsystem<FileSystem>() };
+    const String dir{ CacheDir(context) };
+    Vector<String> files{};
+    fileSystem->ScanDir(files, dir, "*.mdl", SCAN_FILES, false);
+
+    if (files.Size() <= TERRAIN_CACHE_FILES)
+        return;
+
+    //Loading a mesh touches its file, so the oldest ones are the least recently used
+    Vector<Pair<unsigned, String> > ages{};
+    for (const String& file : files)
+        ages.Push(MakePair(fileSystem->GetLastModifiedTime(dir + file), file));
+
+    Sort(ages.Begin(), ages.End());
+
+    for (unsigned f{0}; f < files.Size() - TERRAIN_CACHE_FILES; ++f)
+        fileSystem->Delete(dir + ages[f].second_);
+}
+
+SharedPtr<Model> TerrainBaker::LoadCached(Context* context, const String& key)
+{
+    HashMap<String, WeakPtr<Model> >::Iterator i{ loaded_.Find(key) };
+    if (i != loaded_.End() && i->second_)
+        return SharedPtr<Model>(i->second_);
+
+    const String path{ CachePath(context, key) };
+    FileSystem* fileSystem{ context->GetSubsystem<FileSystem>() };
+    if (!fileSystem->FileExists(path))
+        return SharedPtr<Model>{};
+
+    File file{ context, path };
+    SharedPtr<Model> model{ new Model(context) };
+
+    if (!model->Load(file)) {
+        Log::Write(LOG_WARNING, "Failed to load cached terrain " + path);
+        return SharedPtr<Model>{};
+    }
+
+    file.Close();
+    fileSystem->SetLastModifiedTime(path, Time::GetTimeSinceEpoch());
+
+    loaded_[key] = model;
+    return model;
+}
+
+void TerrainBaker::StoreCached(Context* context, Model* model, const String& key)
+{
+    if (!model)
+        return;
+
+    loaded_[key] = model;
+
+    const String path{ CachePath(context, key) };
+    FileSystem* fileSystem{ context->GetSubsystem<FileSystem>() };
+    fileSystem->CreateDir(GetPath(path));
+
+    File file{ context, path, FILE_WRITE };
+    if (!file.IsOpen() || !model->Save(file))
+        Log::Write(LOG_WARNING, "Failed to store cached terrain " + path);
+
+    file.Close();
+
+    //Trimming scans the whole directory, so it runs with the first store and then now and then
+    if (storeCount_++ % TERRAIN_CACHE_TRIM_INTERVAL == 0)
+        TrimCache(context);
+}
@@ -0,0 +1,62 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef TERRAINBAKER_H
+#define TERRAINBAKER_H
+
+#include <Urho3D/Urho3D.h>
+
+#include "luckey.h"
+
+//Cached meshes kept on disk before the least recently used are dropped
+#define TERRAIN_CACHE_FILES 256
+//Stores between scans of the cache directory
+#define TERRAIN_CACHE_TRIM_INTERVAL 32
+
+//Merges transformed copies of static models into a single model with one
+//vertex and index buffer. Source models need shadowed buffers, which is the
+//default for models loaded through the resource cache.
+class TerrainBaker
+{
+public:
+    TerrainBaker(Context* context);
+
+    void AddPiece(Model* model, const Matrix3x4& transform);
+    SharedPtr<Model> Bake();
+    bool IsEmpty() const { return indexData_.Empty(); }
+
+    //Baked models are shared in memory and stored on disk by content key
+    static SharedPtr<Model> LoadCached(Context* context, const String& key);
+    static void StoreCached(Context* context, Model* model, const String& key);
+
+private:
+    static String CacheDir(Context* context);
+    static String CachePath(Context* context, const String& key);
+    static void TrimCache(Context* context);
+    static HashMap<String, WeakPtr<Model> > loaded_;
+    static unsigned storeCount_;
+
+    Context* context_;
+    PODVector<VertexElement> elements_;
+    unsigned vertexSize_;
+    PODVector<unsigned char> vertexData_;
+    PODVector<unsigned> indexData_;
+    BoundingBox boundingBox_;
+};
+
+#endif // TERRAINBAKER_H
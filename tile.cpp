@@ -18,9 +18,10 @@
 
 #include "tile.h"
 #include "ekelplitf.h"
-#include "frop.h"
-#include "grass.h"
+#include "fropfield.h"
 #include "platform.h"
+#include "autotile.h"
+#include "terrainbaker.h"
 
 void Tile::RegisterObject(Context *context)
 {
@@ -29,6 +30,14 @@ void Tile::RegisterObject(Context *context)
 
 Tile::Tile(Context *context):
 SceneObject(context),
+  elements_{},
+  pieces_{},
+  rotations_{},
+  variants_{},
+  modelGroups_{},
+  centerGroup_{},
+  decorations_{},
+  imps_{},
   health_{1.0f}
 {
 
@@ -45,17 +54,7 @@ void Tile::OnNodeSet(Node *node)
 //    centerModel->SetMaterial(RESOURCE->GetMaterial("VCol"));
 //    centerModel->SetCastShadows(true);
 
-    //Set up compound nodes.
-    for (int i{0}; i < TE_LENGTH; ++i) {
-        elements_[i] = node_->CreateChild("TilePart");
-        elements_[i]->SetPosition(ElementPosition(static_cast<TileElement>(i)));
-//        if (i < 3) elements_[i]->Rotate(Quaternion(0.0f, 180.0f, 0.0f));
-
-//        StaticModel* model{ elements_[i]->CreateComponent<StaticModel>() };
-//        model->SetCastShadows(true);
-    }
-
-//    SubscribeToEvent(E_PHYSICSPOSTSTEP, URHO3D_HANDLER(Tile, HandleFixedUpdate));
+    //Compound nodes are created when an element is first instanced
 }
 Vector3 Tile::ElementPosition(TileElement element)
 {
@@ -67,116 +66,142 @@ Vector3 Tile::ElementPosition(TileElement element)
 
 void Tile::Set(const IntVector2 coords, Platform *platform)
 {
+    ClearInstances();
+
     coords_ = coords;
     platform_ = platform;
+    buildingType_ = B_EMPTY;
+    platform_->occupancy_.SetBuilding(coords_, buildingType_);
 
     node_->SetParent(platform_->GetNode());
     node_->SetRotation(Quaternion::IDENTITY);
 
     SceneObject::Set(platform_->CoordsToPosition(coords));
+    //Piece nodes are kept between uses and are instanced again by FixFringe
+    for (int e{0}; e < TE_LENGTH; ++e) {
 
-    platform_->AddNodeInstance("Terrain/Center_1", node_);
+        if (elements_[e])
+            elements_[e]->SetEnabled(true);
+    }
 
-    //Add collision shape to platform
-    collider_ = platform_->GetNode()->CreateComponent<CollisionShape>();
-    collider_->SetBox(Vector3(1.0f, 0.5f, 1.0f),
-                            node_->GetPosition());
-//    collider_->SetEnabled(true);
+    if (!platform_->IsBaked())
+        centerGroup_ = platform_->AddNodeInstance("Terrain/Center_1", node_);
 
     //Increase platform mass
-    platform_->rigidBody_->SetMass(platform_->rigidBody_->GetMass() + 1.0f);
+    platform_->AddMass(coords_, TILE_MASS);
+
+    for (int e{0}; e < TE_LENGTH; ++e)
+        variants_[e] = StableVariant(coords_, static_cast<TileElement>(e));
+}
 
-    //Create random tile addons
-    int extraRandomizer{ Random(23) };
+unsigned char Tile::StableVariant(IntVector2 coords, TileElement element)
+{
+    //Identical shapes get identical terrain, so baked meshes can be shared
+    const unsigned cell{ RandomStream::Derive(static_cast<unsigned>(coords.x_), static_cast<unsigned>(coords.y_)) };
+    return 1 + RandomStream::Derive(cell, element) % 4;
+}
 
+void Tile::Decorate(TileExtra extra, const Vector3* props, unsigned numProps)
+{
+    switch (extra) {
     //Create a dreamspire
-    if (extraRandomizer == 7) {
+    case TX_SPIRE: {
         Node* spireNode{ node_->CreateChild("Spire") };
+        decorations_.Push(spireNode);
         spireNode->Translate(Vector3::UP * PLATFORM_HALF_THICKNESS);
         if (coords_.x_ % 2) spireNode->Rotate(Quaternion(180.0f, Vector3::UP));
         StaticModel* model{ spireNode->CreateComponent<StaticModel>() };
         model->SetModel(RESOURCE->GetModel("Abode"));
         model->SetMaterial(0, RESOURCE->GetMaterial("Abode"));
         model->SetCastShadows(true);
-    }
+        model->SetViewMask(VM_SCENERY);
+    } break;
     //Create Ekelplitfs
-    else if (extraRandomizer < 7){
-        int totalImps{Random(0, 2)};
-        for (int i{0}; i < totalImps; ++i){
-            Vector3 position{ Vector3(-0.075f * totalImps + 0.15f * i, PLATFORM_HALF_THICKNESS, Random(-0.5f, 0.5f)) };
-            SPAWN->Create<Ekelplitf>()->Set(position, node_);
+    case TX_IMPS: {
+        for (unsigned i{0}; i < numProps; ++i) {
+
+            Ekelplitf* imp{ SPAWN->Create<Ekelplitf>() };
+            imp->Set(props[i], node_, platform_->impRandom_);
+            imps_.Push(imp);
         }
-    }
+    } break;
     //Create fire
-    else if (extraRandomizer == 8){
+    case TX_FIRE: {
         Node* fireNode{ node_->CreateChild("Fire") };
+        decorations_.Push(fireNode);
         fireNode->Translate(Vector3::DOWN * PLATFORM_HALF_THICKNESS * 2.0f);
         ParticleEmitter* particleEmitter{ fireNode->CreateComponent<ParticleEmitter>() };
         ParticleEffect* particleEffect{ CACHE->GetResource<ParticleEffect>("Resources/Particles/Fire.xml") };
         particleEmitter->SetEffect(particleEffect);
+        particleEmitter->SetViewMask(VM_SCENERY);
         Light* fireLight{fireNode->CreateComponent<Light>()};
         fireLight->SetRange(2.3f);
         fireLight->SetColor(Color(1.0f, 0.88f, 0.666f));
         fireLight->SetCastShadows(true);
-    }
+    } break;
     //Create frop crops
-    else if (extraRandomizer > 8 && coords.y_ % 2 == 0){
-        for (int i{0}; i < 4; ++i){
-            for (int j{0}; j < 3; ++j){
-                    Vector3 position{ Vector3(-0.375f + i * 0.25f, PLATFORM_HALF_THICKNESS, -0.3f + j * 0.3f) };
-                    SPAWN->Create<Frop>()->Set(position, node_);
-            }
-        }
-        for (int i = 0; i < extraRandomizer - 8; i++){
-            Vector3 randomPosition{ Vector3(Random(-0.4f, 0.4f), PLATFORM_HALF_THICKNESS, Random(-0.4f, 0.4f)) };
-            SPAWN->Create<Frop>()->Set(randomPosition, node_);
-        }
+    case TX_FROPS: {
+        for (unsigned i{0}; i < numProps; ++i)
+            platform_->fropField_->Plant(props[i], node_, coords_, platform_->fropRandom_);
+    } break;
+    default: break;
     }
 }
 
 void Tile::Disable()
 {
-    collider_->SetEnabled(false);
+    platform_->AddMass(coords_, -TILE_MASS);
+    if (buildingType_ == B_ENGINE)
+        platform_->propulsion_->RemoveEngine(node_->GetPosition());
+
+    platform_->fropField_->Uproot(coords_);
+    ClearInstances();
+
+    for (Node* decoration : decorations_)
+        decoration->Remove();
+    decorations_.Clear();
 
-    platform_->rigidBody_->SetMass(platform_->rigidBody_->GetMass() - 1.0f);
+    for (Ekelplitf* imp : imps_)
+        imp->Disable();
+    imps_.Clear();
+
+    SceneObject::Disable();
 }
 
-void Tile::Start()
+void Tile::ClearInstances()
 {
+    if (centerGroup_) {
+        centerGroup_->RemoveInstanceNode(node_);
+        centerGroup_ = nullptr;
+    }
+
+    for (int e{0}; e < TE_LENGTH; ++e) {
+
+        if (modelGroups_[e]) {
+            modelGroups_[e]->RemoveInstanceNode(elements_[e]);
+            modelGroups_[e] = nullptr;
+        }
+
+        pieces_[e] = CT_NONE;
+    }
 }
-void Tile::Stop()
+
+void Tile::Start()
 {
 }
-
-void Tile::FixedUpdate(float timeStep)
+void Tile::Stop()
 {
-    Input* input{GetSubsystem<Input>()};
-
-    bool up{ input->GetKeyDown(KEY_UP) };
-    bool down{ input->GetKeyDown(KEY_DOWN) };
-    bool left{ input->GetKeyDown(KEY_LEFT) };
-    bool right{ input->GetKeyDown(KEY_RIGHT) };
-
-    if (buildingType_ == B_ENGINE) {
-        if (true)//up
-//         || (left && node_->GetPosition().x_ > 0.0f)
-//         || (right && node_->GetPosition().x_ < 0.0f))
-        {
-            platform_->rigidBody_->ApplyForce(platform_->GetNode()->GetDirection() * 5000.0f * timeStep, node_->GetPosition());
-        }
-        else if (down
-                || (right && node_->GetPosition().x_ > 0.0f)
-                || (left && node_->GetPosition().x_ < 0.0f))
-        {
-            platform_->rigidBody_->ApplyForce(-platform_->GetNode()->GetDirection() * 5000.0f * timeStep, node_->GetPosition());
-        }
-    }
 }
 
 void Tile::SetBuilding(BuildingType type)
 {
+    if (buildingType_ == B_ENGINE && type != B_ENGINE)
+        platform_->propulsion_->RemoveEngine(node_->GetPosition());
+    else if (buildingType_ != B_ENGINE && type == B_ENGINE)
+        platform_->propulsion_->AddEngine(node_->GetPosition());
+
     buildingType_ = type;
-    if (buildingType_ > B_EMPTY) platform_->DisableSlot(coords_);
+    platform_->occupancy_.SetBuilding(coords_, buildingType_);
 //    StaticModel* model{ node_->GetComponent<StaticModel>() };
     switch (buildingType_)
     {
@@ -196,104 +221,70 @@ BuildingType Tile::GetBuilding()
     return buildingType_;
 }
 
+String Tile::PieceModel(CornerType type, unsigned char variant)
+{
+    switch (type) {
+    case CT_IN:       return "Terrain/BendIn_" + String(variant);
+    case CT_OUT:      return "Terrain/BendOut_" + String(variant);
+    case CT_STRAIGHT: return "Terrain/Straight_" + String(variant);
+    case CT_BRIDGE:   return "Terrain/Bridge_1";
+    case CT_FILL:     return "Terrain/Fill_1";
+    default:          return String::EMPTY;
+    }
+}
+
 void Tile::FixFringe()
 {
+    const FringeTile& fringe{ AutoTile::Lookup(platform_->GetNeighbourMask(coords_)) };
+    const bool baked{ platform_->IsBaked() };
+
     for (int e{0}; e < TE_LENGTH; ++e) {
 
-        Node* element{ elements_[e] };
-//        StaticModel* model{ element->GetComponent<StaticModel>() };
-
-        CornerType cornerType{ platform_->PickCornerType(coords_, static_cast<TileElement>(e)) };
-
-        switch (cornerType) {
-        case CT_NONE:
-//            model->SetModel(nullptr);
-            break;
-        case CT_IN: {
-            platform_->AddNodeInstance("Terrain/BendIn_" + String(Random(1, 5)), element);
-
-//            model->SetModel(RESOURCE->GetModel("Terrain/BendIn_" + String(Random(1, 5))));
-
-            switch (e) {
-            case TE_NORTHEAST:
-                elements_[e]->SetRotation(Quaternion(0.0f, 180.0f, 0.0f));
-                break;
-            case TE_SOUTHEAST:
-                elements_[e]->SetRotation(Quaternion(0.0f, -90.0f, 0.0f));
-                break;
-            case TE_SOUTHWEST:
-                elements_[e]->SetRotation(Quaternion(0.0f, 0.0f, 0.0f));
-                break;
-            case TE_NORTHWEST:
-                elements_[e]->SetRotation(Quaternion(0.0f, 90.0f, 0.0f));
-                break;
-            }
-        } break;
-        case CT_OUT: {
-            platform_->AddNodeInstance("Terrain/BendOut_" + String(Random(1, 5)), element);
-
-//                model->SetModel(RESOURCE->GetModel("Terrain/BendOut_" + String(Random(1, 5))));
-
-                switch (e) {
-                case TE_NORTHEAST:
-                    elements_[e]->SetRotation(Quaternion(0.0f, 180.0f, 0.0f));
-                    break;
-                case TE_SOUTHEAST:
-                    elements_[e]->SetRotation(Quaternion(0.0f, -90.0f, 0.0f));
-                    break;
-                case TE_SOUTHWEST:
-                    elements_[e]->SetRotation(Quaternion(0.0f, 0.0f, 0.0f));
-                    break;
-                case TE_NORTHWEST:
-                    elements_[e]->SetRotation(Quaternion(0.0f, 90.0f, 0.0f));
-                    break;
-                }
-        } break;
-        case CT_STRAIGHT: {
-            platform_->AddNodeInstance("Terrain/Straight_" + String(Random(1, 5)), element);
-//                model->SetModel(RESOURCE->GetModel("Terrain/Straight_" + String(Random(1, 5))));
-
-                switch (e) {
-                case TE_NORTHEAST:
-                    elements_[e]->SetRotation(Quaternion(0.0f, 180.0f, 0.0f));
-                    break;
-                case TE_SOUTHEAST:
-                    elements_[e]->SetRotation(Quaternion(0.0f, -90.0f, 0.0f));
-                    break;
-                case TE_SOUTHWEST:
-                    elements_[e]->SetRotation(Quaternion(0.0f, 0.0f, 0.0f));
-                    break;
-                case TE_NORTHWEST:
-                    elements_[e]->SetRotation(Quaternion(0.0f, 90.0f, 0.0f));
-                    break;
-                }
-        } break;
-        case CT_BRIDGE: {
-            platform_->AddNodeInstance("Terrain/Bridge_1", element);
-
-//            model->SetModel(RESOURCE->GetModel("Terrain/Bridge_1"));
-
-            switch (e) {
-            case TE_NORTHEAST: case TE_SOUTHWEST:
-                elements_[e]->SetRotation(Quaternion(0.0f, 0.0f, 0.0f));
-                break;
-            case TE_SOUTHEAST: case TE_NORTHWEST:
-                elements_[e]->SetRotation(Quaternion(0.0f, 90.0f, 0.0f));
-                break;
-            }
-        } break;
-        case CT_FILL: {
-            if (e == TE_NORTHEAST)
-                platform_->AddNodeInstance("Terrain/Fill_1", element);
-
-//                model->SetModel(RESOURCE->GetModel("Terrain/Fill_1"));
-//            else
-//                model->SetModel(nullptr);
-
-        } break;
-        default: break;
+        const FringeElement& piece{ fringe.elements_[e] };
+        //Only the north east element draws the shared fill piece
+        const CornerType type{ piece.type_ == CT_FILL && e != TE_NORTHEAST ? CT_NONE
+                                                                          : piece.type_ };
+        //Unchanged pieces keep their instance and variant
+        if (type == pieces_[e])
+            continue;
+
+        pieces_[e] = type;
+        rotations_[e] = piece.rotation_;
+
+        if (modelGroups_[e]) {
+            modelGroups_[e]->RemoveInstanceNode(elements_[e]);
+            modelGroups_[e] = nullptr;
+        }
+
+        const String model{ PieceModel(type, variants_[e]) };
+
+        //Baked platforms draw the piece from their terrain mesh
+        if (model.Empty() || baked)
+            continue;
+
+        if (!elements_[e]) {
+            elements_[e] = node_->CreateChild("TilePart");
+            elements_[e]->SetPosition(ElementPosition(static_cast<TileElement>(e)));
         }
-//        if (model->GetModel())
-//            model->SetMaterial(RESOURCE->GetMaterial("VCol"));
+
+        elements_[e]->SetRotation(Quaternion(0.0f, piece.rotation_, 0.0f));
+        modelGroups_[e] = platform_->AddNodeInstance(model, elements_[e]);
+    }
+}
+
+void Tile::Bake(TerrainBaker& baker) const
+{
+    const Vector3 position{ node_->GetPosition() };
+    baker.AddPiece(RESOURCE->GetModel("Terrain/Center_1"), Matrix3x4(position, Quaternion::IDENTITY, 1.0f));
+
+    for (int e{0}; e < TE_LENGTH; ++e) {
+
+        const String model{ PieceModel(pieces_[e], variants_[e]) };
+        if (model.Empty())
+            continue;
+
+        baker.AddPiece(RESOURCE->GetModel(model),
+                       Matrix3x4(position + ElementPosition(static_cast<TileElement>(e)),
+                                 Quaternion(0.0f, rotations_[e], 0.0f), 1.0f));
     }
 }
@@ -33,7 +33,11 @@ class Sprite;
 
 using namespace Urho3D;
 
+#define TILE_MASS 1.0f
+
 class Platform;
+class TerrainBaker;
+class Ekelplitf;
 //class BuildingType;
 
 class Tile : public SceneObject
@@ -44,6 +48,7 @@ public:
     Tile(Context *context);
     static void RegisterObject(Context* context);
     virtual void Set(const IntVector2 coords, Platform *platform);
+    void Decorate(TileExtra extra, const Vector3* props, unsigned numProps);
 
     virtual void Start();
     virtual void Stop();
@@ -56,16 +61,25 @@ public:
     void OnNodeSet(Node* node);
     void Disable();
     static Vector3 ElementPosition(TileElement element);
+    static String PieceModel(CornerType type, unsigned char variant);
+    static unsigned char StableVariant(IntVector2 coords, TileElement element);
 private:
-    void FixedUpdate(float timeStep);
     Platform* platform_;
     Node* elements_[TE_LENGTH];
+    CornerType pieces_[TE_LENGTH];
+    float rotations_[TE_LENGTH];
+    unsigned char variants_[TE_LENGTH];
     StaticModelGroup* modelGroups_[TE_LENGTH];
-    CollisionShape* collider_;
+    StaticModelGroup* centerGroup_;
+    //Spires, fires and imps of the current occupant, removed when it is disabled
+    PODVector<Node*> decorations_;
+    PODVector<Ekelplitf*> imps_;
     float health_;
     void SetBuilding(BuildingType type);
     BuildingType GetBuilding();
     void FixFringe();
+    void Bake(TerrainBaker& baker) const;
+    void ClearInstances();
 
 };
 
@@ -1,5 +1,5 @@
 /* Masters of Oneiron
-// Copyright (C) 2016 LucKey Productions (luckeyproductions.nl)
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
 //
 // This program is free software; you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
@@ -16,36 +16,19 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
-#ifndef GRASS_H
-#define GRASS_H
+#include "updatemaster.h"
 
-#include <Urho3D/Urho3D.h>
-
-#include "sceneobject.h"
-
-namespace Urho3D {
-class Drawable;
-class Node;
-class Scene;
-class Sprite;
+UpdateMaster::UpdateMaster(Context* context): Object(context),
+    lists_{}
+{
+    SubscribeToEvent(E_SCENEUPDATE, URHO3D_HANDLER(UpdateMaster, HandleSceneUpdate));
 }
 
-using namespace Urho3D;
+void UpdateMaster::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{ (void)eventType;
 
-class Grass : public SceneObject
-{
-    URHO3D_OBJECT(Grass, SceneObject);
-public:
-    Grass(Context *context);
-    static void RegisterObject(Context* context);
-    virtual void Start();
-    virtual void Stop();
-    void OnNodeSet(Node* node);
-    void Set(Vector3 position, Node* parent);
-private:
-    void HandleUpdate(StringHash eventType, VariantMap& eventData);
-    StaticModel* grassModel_;
-    double randomizer_;
-};
+    const float timeStep{ eventData[SceneUpdate::P_TIMESTEP].GetFloat() };
 
-#endif // GRASS_H
+    for (HashMap<StringHash, SharedPtr<UpdateListBase> >::Iterator l{ lists_.Begin() }; l != lists_.End(); ++l)
+        l->second_->Update(timeStep);
+}
@@ -0,0 +1,117 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef UPDATEMASTER_H
+#define UPDATEMASTER_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+
+//Type erased handle so lists of different types can be stored together
+class UpdateListBase : public RefCounted
+{
+public:
+    virtual void Update(float timeStep) = 0;
+};
+
+//Keeps the registered components of one type in a contiguous array and
+//passes them all to T::UpdateAll(T** components, unsigned count, float timeStep).
+//Changes made while updating take effect once the batch is done.
+template <class T> class UpdateList : public UpdateListBase
+{
+public:
+    UpdateList():
+        components_{},
+        added_{},
+        removed_{},
+        updating_{false}
+    {
+    }
+
+    void Add(T* component)
+    {
+        if (updating_)
+            added_.Push(component);
+        else
+            components_.Push(component);
+    }
+    void Remove(T* component)
+    {
+        if (updating_) {
+
+            if (!added_.Remove(component))
+                removed_.Push(component);
+
+        } else {
+
+            components_.RemoveSwap(component);
+        }
+    }
+
+    void Update(float timeStep) override
+    {
+        if (!components_.Empty()) {
+
+            updating_ = true;
+            T::UpdateAll(components_.Buffer(), components_.Size(), timeStep);
+            updating_ = false;
+        }
+
+        for (T* component : removed_)
+            components_.RemoveSwap(component);
+        components_.Push(added_);
+
+        removed_.Clear();
+        added_.Clear();
+    }
+
+private:
+    PODVector<T*> components_;
+    PODVector<T*> added_;
+    PODVector<T*> removed_;
+    bool updating_;
+};
+
+//Updates components per type in batches instead of through one event
+//subscription each. Components that have nothing to do stay unregistered.
+class UpdateMaster : public Object
+{
+    URHO3D_OBJECT(UpdateMaster, Object);
+public:
+    UpdateMaster(Context* context);
+
+    template <class T> void Register(T* component) { GetList<T>()->Add(component); }
+    template <class T> void Unregister(T* component) { GetList<T>()->Remove(component); }
+
+private:
+    //In order of first registration
+    HashMap<StringHash, SharedPtr<UpdateListBase> > lists_;
+
+    template <class T> UpdateList<T>* GetList()
+    {
+        SharedPtr<UpdateListBase>& list{ lists_[T::GetTypeStatic()] };
+        if (!list)
+            list = new UpdateList<T>();
+
+        return static_cast<UpdateList<T>*>(list.Get());
+    }
+
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+};
+
+#endif // UPDATEMASTER_H
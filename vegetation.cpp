@@ -0,0 +1,133 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "vegetation.h"
+
+void Vegetation::RegisterObject(Context* context)
+{
+    context->RegisterFactory<Vegetation>();
+}
+
+Vegetation::Vegetation(Context* context) : StaticModel(context),
+    instances_{},
+    worldTransforms_{}
+{
+}
+
+void Vegetation::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results)
+{
+    //Vegetation is never picked
+    (void)query;
+    (void)results;
+}
+
+void Vegetation::UpdateBatches(const FrameInfo& frame)
+{
+    //Getting the world bounding box updates the instance transforms as well
+    const BoundingBox& worldBoundingBox{ GetWorldBoundingBox() };
+    const Matrix3x4& worldTransform{ node_->GetWorldTransform() };
+    distance_ = frame.camera_->GetDistance(worldBoundingBox.Center());
+
+    //Nothing to draw until instances are added
+    if (instances_.Empty()) {
+
+        for (unsigned i{0}; i < batches_.Size(); ++i)
+            batches_[i].numWorldTransforms_ = 0;
+
+        return;
+    }
+
+    for (unsigned i{0}; i < batches_.Size(); ++i) {
+
+        batches_[i].distance_ = batches_.Size() > 1 ? frame.camera_->GetDistance(worldTransform * geometryData_[i].center_)
+                                                    : distance_;
+        batches_[i].worldTransform_ = &worldTransforms_[0];
+        batches_[i].numWorldTransforms_ = worldTransforms_.Size();
+    }
+
+    const float scale{ worldBoundingBox.Size().DotProduct(DOT_SCALE) };
+    const float newLodDistance{ frame.camera_->GetLodDistance(distance_, scale, lodBias_) };
+
+    if (newLodDistance != lodDistance_) {
+
+        lodDistance_ = newLodDistance;
+        CalculateLodLevels();
+    }
+}
+
+void Vegetation::OnWorldBoundingBoxUpdate()
+{
+    //Transforms and bounds in one pass over the instances
+    const Matrix3x4& worldTransform{ node_->GetWorldTransform() };
+    BoundingBox worldBox{};
+
+    for (unsigned i{0}; i < instances_.Size(); ++i) {
+
+        worldTransforms_[i] = worldTransform * instances_[i];
+        worldBox.Merge(boundingBox_.Transformed(worldTransforms_[i]));
+    }
+
+    //Without instances the box collapses onto the node
+    worldBoundingBox_ = worldBox.Defined() ? worldBox
+                                           : BoundingBox(node_->GetWorldPosition(), node_->GetWorldPosition());
+}
+
+unsigned Vegetation::AddInstance(const Matrix3x4& transform)
+{
+    instances_.Push(transform);
+    worldTransforms_.Resize(instances_.Size());
+    MarkInstancesDirty();
+
+    return instances_.Size() - 1;
+}
+
+void Vegetation::SetInstance(unsigned index, const Matrix3x4& transform)
+{
+    instances_[index] = transform;
+    MarkInstancesDirty();
+}
+
+void Vegetation::SwapInstances(unsigned a, unsigned b)
+{
+    Swap(instances_[a], instances_[b]);
+    MarkInstancesDirty();
+}
+
+void Vegetation::RemoveLastInstance()
+{
+    instances_.Pop();
+    worldTransforms_.Resize(instances_.Size());
+    MarkInstancesDirty();
+}
+
+void Vegetation::SetInstances(const PODVector<Matrix3x4>& transforms)
+{
+    if (transforms == instances_)
+        return;
+
+    instances_ = transforms;
+    worldTransforms_.Resize(instances_.Size());
+    MarkInstancesDirty();
+}
+
+void Vegetation::MarkInstancesDirty()
+{
+    //Requeues the drawable in the octree with its new bounds
+    if (node_)
+        OnMarkedDirty(node_);
+}
@@ -0,0 +1,57 @@
+/* Masters of Oneiron
+// Copyright (C) 2017 LucKey Productions (luckeyproductions.nl)
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef VEGETATION_H
+#define VEGETATION_H
+
+#include <Urho3D/Urho3D.h>
+#include "luckey.h"
+
+//Draws many copies of one model without a node per copy. Instance
+//transforms are kept relative to the owning node and all copies share one
+//instanced batch per material.
+class Vegetation : public StaticModel
+{
+    URHO3D_OBJECT(Vegetation, StaticModel);
+public:
+    Vegetation(Context* context);
+    static void RegisterObject(Context* context);
+
+    void ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results) override;
+    void UpdateBatches(const FrameInfo& frame) override;
+
+    unsigned AddInstance(const Matrix3x4& transform);
+    void SetInstance(unsigned index, const Matrix3x4& transform);
+    const Matrix3x4& GetInstance(unsigned index) const { return instances_[index]; }
+    void SwapInstances(unsigned a, unsigned b);
+    void RemoveLastInstance();
+    //Replaces all instances at once
+    void SetInstances(const PODVector<Matrix3x4>& transforms);
+    unsigned GetNumInstances() const { return instances_.Size(); }
+
+protected:
+    void OnWorldBoundingBoxUpdate() override;
+
+private:
+    void MarkInstancesDirty();
+
+    PODVector<Matrix3x4> instances_;
+    PODVector<Matrix3x4> worldTransforms_;
+};
+
+#endif // VEGETATION_H
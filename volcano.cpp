@@ -19,6 +19,7 @@
 
 #include "resourcemaster.h"
 #include "world.h"
+#include "shellindex.h"
 #include "volcano.h"
 
 
@@ -40,16 +41,22 @@ void Volcano::Set(Vector3 position)
 {
     SceneObject::Set(position);
 
-    Vector3 rhombicCenter{ GetScene()->GetComponent<World>()->GetNearestRhombicCenter(node_->GetWorldPosition()) };
+    //Face the center of the nearest face, at the same height
+    World* world{ GetScene()->GetComponent<World>() };
+    const ShellCoords coords{ world->ToShell(node_->GetWorldPosition()) };
 
-    node_->LookAt(node_->GetWorldPosition() + (rhombicCenter - node_->GetWorldPosition().Normalized() * rhombicCenter.ProjectOntoAxis(node_->GetWorldPosition())),
+    node_->LookAt(world->FromShell(ShellCoords(coords.face_, Vector2::ZERO, coords.height_)),
                   node_->GetWorldPosition().Normalized());
 
-    node_->CreateComponent<StaticModel>()->SetModel(RESOURCE->GetModel("Box"));
+    StaticModel* model{ node_->CreateComponent<StaticModel>() };
+    model->SetModel(RESOURCE->GetModel("Box"));
+    model->SetViewMask(VM_SCENERY);
     node_->SetScale(Vector3(42.0f, 42.0f, 42.0f));
 
     node_->CreateComponent<RigidBody>();
     node_->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+
+    GetScene()->GetComponent<ShellIndex>()->Insert(node_, GetType());
 }
 
 void Volcano::Update(float timeStep)
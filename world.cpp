@@ -17,11 +17,17 @@
 */
 
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "mastercontrol.h"
 #include "resourcemaster.h"
 #include "spawnmaster.h"
 #include "volcano.h"
 #include "storm.h"
+#include "platform.h"
+#include "shellindex.h"
 #include "world.h"
 
 const Vector3 World::v0(M_PHI,	0.0f, M_PHI_P2);
@@ -66,6 +72,14 @@ void World::RegisterObject(Context* context)
 
 World::World(Context* context) : LogicComponent(context),
     rhombicCenters_{},
+    faceNormals_{},
+    faceAxesU_{},
+    faceAxesV_{},
+    halfDiagonals_{},
+    faceNeighbours_{},
+    normalX_{},
+    normalY_{},
+    normalZ_{},
     radius_{235.0f}
 {
 }
@@ -79,6 +93,7 @@ void World::OnNodeSet(Node* node)
     StaticModel* object{ bubbleNode->CreateComponent<StaticModel>() };
     object->SetModel(CreateRhombicTriacontahedron(radius_, 0.05f));
     object->SetMaterial(RESOURCE->GetMaterial("Bubble"));
+    object->SetViewMask(VM_SCENERY);
 
     //Create volcanoes
     for (Vector3 v : GetIcosahedricPoints())
@@ -232,10 +247,30 @@ SharedPtr<Model> World::CreateRhombicTriacontahedron(float radius, float thickne
 
         n1 = n2 = n3 = n4 = normal;
 
-        if (rhombicCenters_.Size() < 30)
+        if (rhombicCenters_.Size() < NUM_SHELL_FACES) {
+
             rhombicCenters_.Push(normal * radius);
+            faceNormals_.Push(normal);
+
+            //The corners farthest from the center end the long diagonal
+            Vector3 farCorner{ v1 };
+            float nearCorner{ M_INFINITY };
+            for (const Vector3& corner : { v1, v2, v3, v4 }) {
+
+                if ((corner - averagePosition).Length() > (farCorner - averagePosition).Length())
+                    farCorner = corner;
+
+                nearCorner = Min(nearCorner, (corner - averagePosition).Length());
+            }
+
+            const float scale{ radius / averagePosition.Length() };
+            faceAxesU_.Push((farCorner - averagePosition).Normalized());
+            halfDiagonals_ = Vector2((farCorner - averagePosition).Length(), nearCorner) * scale;
+        }
     }
 
+    UpdateFaceTables();
+
     SharedPtr<Model> fromScratchModel(new Model(context_));
     SharedPtr<VertexBuffer> vb(new VertexBuffer(context_));
     SharedPtr<IndexBuffer> ib(new IndexBuffer(context_));
@@ -279,29 +314,306 @@ SharedPtr<Model> World::CreateRhombicTriacontahedron(float radius, float thickne
     return fromScratchModel;
 }
 
-Vector3 World::GetNearestRhombicCenter(Vector3 position)
+void World::UpdateFaceTables()
 {
-    Vector3 rhombicCenter{};
-    for (Vector3 center : GetRhombicCenters()) {
-        if (rhombicCenter == Vector3::ZERO
-                || LucKey::Distance(position, center)
-                < LucKey::Distance(position, rhombicCenter))
-        {
-            rhombicCenter = center;
+    faceAxesV_.Clear();
+    for (unsigned f{0}; f < faceNormals_.Size(); ++f)
+        faceAxesV_.Push(faceNormals_[f].CrossProduct(faceAxesU_[f]));
+
+    //Neighbours share the plane through an edge's midpoint, all other
+    //faces of the convex shell lie below it
+    const Vector2 midpoints[SE_LENGTH]{ Vector2( 0.5f,  0.5f), Vector2(-0.5f,  0.5f),
+                                        Vector2(-0.5f, -0.5f), Vector2( 0.5f, -0.5f) };
+
+    for (unsigned f{0}; f < faceNormals_.Size(); ++f) {
+        for (int e{0}; e < SE_LENGTH; ++e) {
+
+            const Vector3 midpoint{ FromShell(ShellCoords(f, midpoints[e] * halfDiagonals_)) };
+            float best{ -M_INFINITY };
+
+            for (unsigned g{0}; g < faceNormals_.Size(); ++g) {
+
+                const float dot{ midpoint.DotProduct(faceNormals_[g]) };
+
+                if (g != f && dot > best) {
+                    best = dot;
+                    faceNeighbours_[f][e] = g;
+                }
+            }
         }
     }
 
-    return rhombicCenter;
+    const unsigned padded{ (faceNormals_.Size() + 3) & ~3u };
+    normalX_.Resize(padded);
+    normalY_.Resize(padded);
+    normalZ_.Resize(padded);
+
+    //Padding repeats the first face so it never wins over it
+    for (unsigned f{0}; f < padded; ++f) {
+
+        const Vector3& normal{ faceNormals_[f < faceNormals_.Size() ? f : 0] };
+        normalX_[f] = normal.x_;
+        normalY_[f] = normal.y_;
+        normalZ_[f] = normal.z_;
+    }
+}
+
+int World::GetFace(const Vector3& position, float* height) const
+{
+#ifdef URHO3D_SSE
+    //Four faces at a time
+    const __m128 x{ _mm_set1_ps(position.x_) };
+    const __m128 y{ _mm_set1_ps(position.y_) };
+    const __m128 z{ _mm_set1_ps(position.z_) };
+    __m128 best{ _mm_set1_ps(-M_INFINITY) };
+    __m128i bestFace{ _mm_setzero_si128() };
+
+    for (unsigned f{0}; f < normalX_.Size(); f += 4) {
+
+        const __m128 dot{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_loadu_ps(&normalX_[f])),
+                                                _mm_mul_ps(y, _mm_loadu_ps(&normalY_[f]))),
+                                                _mm_mul_ps(z, _mm_loadu_ps(&normalZ_[f]))) };
+        const __m128i better{ _mm_castps_si128(_mm_cmpgt_ps(dot, best)) };
+
+        best = _mm_max_ps(dot, best);
+        bestFace = _mm_or_si128(_mm_and_si128(better, _mm_setr_epi32(f, f + 1, f + 2, f + 3)),
+                                _mm_andnot_si128(better, bestFace));
+    }
+
+    float dots[4];
+    int faces[4];
+    _mm_storeu_ps(dots, best);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(faces), bestFace);
+
+    int face{ faces[0] };
+    float dot{ dots[0] };
+
+    for (int l{1}; l < 4; ++l) {
+
+        if (dots[l] > dot || (dots[l] == dot && faces[l] < face)) {
+            dot = dots[l];
+            face = faces[l];
+        }
+    }
+#else
+    int face{ 0 };
+    float dot{ -M_INFINITY };
+
+    for (unsigned f{0}; f < faceNormals_.Size(); ++f) {
+
+        const float d{ position.x_ * normalX_[f] + position.y_ * normalY_[f] + position.z_ * normalZ_[f] };
+
+        if (d > dot) {
+            dot = d;
+            face = f;
+        }
+    }
+#endif
+
+    if (height)
+        *height = dot;
+
+    return face;
+}
+
+void World::GetFaces(const float* x, const float* y, const float* z, unsigned count, int* faces, float* heights) const
+{
+    const unsigned numFaces{ faceNormals_.Size() };
+    unsigned p{ 0 };
+
+#ifdef URHO3D_SSE
+    //Four positions at a time
+    for (; p + 4 <= count; p += 4) {
+
+        const __m128 px{ _mm_loadu_ps(x + p) };
+        const __m128 py{ _mm_loadu_ps(y + p) };
+        const __m128 pz{ _mm_loadu_ps(z + p) };
+        __m128 best{ _mm_set1_ps(-M_INFINITY) };
+        __m128i bestFace{ _mm_setzero_si128() };
+
+        for (unsigned f{0}; f < numFaces; ++f) {
+
+            const __m128 dot{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(normalX_[f])),
+                                                    _mm_mul_ps(py, _mm_set1_ps(normalY_[f]))),
+                                                    _mm_mul_ps(pz, _mm_set1_ps(normalZ_[f]))) };
+            const __m128i better{ _mm_castps_si128(_mm_cmpgt_ps(dot, best)) };
+
+            best = _mm_max_ps(dot, best);
+            bestFace = _mm_or_si128(_mm_and_si128(better, _mm_set1_epi32(f)),
+                                    _mm_andnot_si128(better, bestFace));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(faces + p), bestFace);
+        if (heights)
+            _mm_storeu_ps(heights + p, best);
+    }
+#endif
+
+    for (; p < count; ++p) {
+
+        float best{ -M_INFINITY };
+        int bestFace{ 0 };
+
+        for (unsigned f{0}; f < numFaces; ++f) {
+
+            const float dot{ x[p] * normalX_[f] + y[p] * normalY_[f] + z[p] * normalZ_[f] };
+
+            if (dot > best) {
+                best = dot;
+                bestFace = f;
+            }
+        }
+
+        faces[p] = bestFace;
+        if (heights)
+            heights[p] = best;
+    }
+}
+
+ShellCoords World::ToShell(const Vector3& position) const
+{
+    float height{};
+    const int face{ GetFace(position, &height) };
+    const Vector3 offset{ position - rhombicCenters_[face] };
+
+    return ShellCoords(face,
+                       Vector2(offset.DotProduct(faceAxesU_[face]), offset.DotProduct(faceAxesV_[face])),
+                       height - radius_);
+}
+
+Vector3 World::FromShell(const ShellCoords& coords) const
+{
+    const int face{ coords.face_ };
+
+    return rhombicCenters_[face]
+         + faceAxesU_[face] * coords.uv_.x_
+         + faceAxesV_[face] * coords.uv_.y_
+         + faceNormals_[face] * coords.height_;
 }
 
 Vector3 World::ToSurface(const Vector3& position)
 {
-    Vector3 rhombicCenter{ GetNearestRhombicCenter(position) };
+    ShellCoords coords{ ToShell(position) };
 
-    if (position.ProjectOntoAxis(rhombicCenter) != radius_) {
+    if (coords.height_ != 0.0f) {
 
-        return position + ((radius_ - position.ProjectOntoAxis(rhombicCenter)) * rhombicCenter.Normalized());
+        coords.height_ = 0.0f;
+        return FromShell(coords);
     } else {
         return position;
     }
 }
+
+bool World::Raycast(const Ray& ray, float& distance, float maxDistance) const
+{
+    //The shell is where all face planes have the point behind them, so the ray
+    //is inside from the last plane it enters until the first plane it leaves
+    float enter{ -M_INFINITY };
+    float exit{ M_INFINITY };
+
+    for (const Vector3& normal : faceNormals_) {
+
+        const float along{ normal.DotProduct(ray.direction_) };
+        const float gap{ radius_ - normal.DotProduct(ray.origin_) };
+
+        if (along == 0.0f) {
+
+            if (gap < 0.0f)
+                return false;
+            else
+                continue;
+        }
+
+        const float t{ gap / along };
+
+        if (along < 0.0f)
+            enter = Max(enter, t);
+        else
+            exit = Min(exit, t);
+
+        if (enter > exit)
+            return false;
+    }
+
+    //From inside the shell the ray hits where it leaves
+    const float hit{ enter >= 0.0f ? enter : exit };
+    if (hit < 0.0f || hit > maxDistance)
+        return false;
+
+    distance = hit;
+    return true;
+}
+
+bool World::Pick(const Ray& ray, float maxDistance, PlatformPick& pick) const
+{
+    //Candidates are the platforms reaching into the sphere around the picked stretch of the ray
+    PODVector<Node*> nodes{};
+    const float halfLength{ 0.5f * Min(maxDistance, 2.0f * M_LARGE_VALUE) };
+    GetScene()->GetComponent<ShellIndex>()->QueryRadius(nodes, ray.origin_ + ray.direction_ * halfLength, halfLength,
+                                                        Platform::GetTypeStatic());
+    bool picked{ false };
+
+    for (Node* node : nodes) {
+
+        Platform* platform{ node->GetComponent<Platform>() };
+
+        if (!platform || ray.HitDistance(platform->GetBoundingSphere()) > maxDistance)
+            continue;
+
+        //Only nearer picks remain of interest
+        if (platform->Pick(ray, maxDistance, pick)) {
+
+            maxDistance = pick.distance_;
+            picked = true;
+        }
+    }
+
+    return picked;
+}
+
+void World::QueryTiles(PODVector<TileHit>& result, const Sphere& sphere) const
+{
+    PODVector<Node*> nodes{};
+    GetScene()->GetComponent<ShellIndex>()->QueryRadius(nodes, sphere.center_, sphere.radius_, Platform::GetTypeStatic());
+
+    for (Node* node : nodes) {
+
+        Platform* platform{ node->GetComponent<Platform>() };
+        if (!platform)
+            continue;
+
+        const Sphere bounds{ platform->GetBoundingSphere() };
+        if (bounds.IsInside(sphere) != OUTSIDE)
+            platform->QueryTiles(result, sphere);
+    }
+}
+
+void World::QueryTilesGeodesic(PODVector<TileHit>& result, const Vector3& center, float distance) const
+{
+    //A disc on the shell covers a cone from the core
+    const Vector3 axis{ center.Normalized() };
+    const float angle{ distance / radius_ * M_RADTODEG };
+
+    PODVector<Node*> nodes{};
+    GetScene()->GetComponent<ShellIndex>()->QueryCone(nodes, axis, angle, Platform::GetTypeStatic());
+
+    for (Node* node : nodes) {
+
+        Platform* platform{ node->GetComponent<Platform>() };
+        if (!platform)
+            continue;
+
+        const Sphere bounds{ platform->GetBoundingSphere() };
+        const float distanceToCore{ bounds.center_.Length() };
+        if (distanceToCore <= bounds.radius_) {
+
+            platform->QueryTiles(result, axis, angle);
+            continue;
+        }
+
+        //Angle the bounds subtend around their own center
+        const float spread{ Asin(bounds.radius_ / distanceToCore) };
+        if (bounds.center_.Angle(axis) <= angle + spread)
+            platform->QueryTiles(result, axis, angle);
+    }
+}
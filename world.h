@@ -23,6 +23,10 @@
 
 #include <Urho3D/Urho3D.h>
 #include "luckey.h"
+#include "shellcoords.h"
+
+struct TileHit;
+struct PlatformPick;
 
 class World : public LogicComponent
 {
@@ -55,8 +59,37 @@ public:
     SharedPtr<Model> CreateRhombicTriacontahedron(float radius = 1.0f, float thickness = 0.0f);
 
     const Vector<Vector3>& GetRhombicCenters() const { return rhombicCenters_; }
-    Vector3 GetNearestRhombicCenter(Vector3 position);
+    Vector3 GetNearestRhombicCenter(Vector3 position) const { return rhombicCenters_[GetFace(position)]; }
     Vector3 ToSurface(const Vector3& position);
+    float GetRadius() const { return radius_; }
+
+    //All face centers lie at the same distance from the core, so the
+    //nearest one belongs to the normal with the largest dot product
+    unsigned GetNumFaces() const { return rhombicCenters_.Size(); }
+    int GetFace(const Vector3& position, float* height = nullptr) const;
+    void GetFaces(const float* x, const float* y, const float* z, unsigned count, int* faces, float* heights = nullptr) const;
+    const Vector3& GetFaceCenter(int face) const { return rhombicCenters_[face]; }
+    const Vector3& GetFaceNormal(int face) const { return faceNormals_[face]; }
+    const Vector3& GetFaceAxisU(int face) const { return faceAxesU_[face]; }
+    const Vector3& GetFaceAxisV(int face) const { return faceAxesV_[face]; }
+
+    ShellCoords ToShell(const Vector3& position) const;
+    Vector3 FromShell(const ShellCoords& coords) const;
+    //Face across an edge of another face
+    int GetNeighbourFace(int face, ShellEdge edge) const { return faceNeighbours_[face][edge]; }
+    //Half lengths of the long and short diagonals of every face
+    const Vector2& GetHalfDiagonals() const { return halfDiagonals_; }
+
+    //Distance along a ray to where it first crosses the shell
+    bool Raycast(const Ray& ray, float& distance, float maxDistance = M_INFINITY) const;
+
+    //Nearest tile or slot of any platform along a ray
+    bool Pick(const Ray& ray, float maxDistance, PlatformPick& pick) const;
+
+    //Tiles of all platforms with their centers inside a sphere
+    void QueryTiles(PODVector<TileHit>& result, const Sphere& sphere) const;
+    //Tiles of all platforms within a distance along the shell from the point below a position
+    void QueryTilesGeodesic(PODVector<TileHit>& result, const Vector3& center, float distance) const;
 private:
     static constexpr float M_PHI    = 1.61803398874989484820458683436564f;
     static constexpr float M_PHI_P2 = 2.61803398874989484820458683436564f;
@@ -81,6 +114,17 @@ private:
     static Vector3 MirrorYZ(const Vector3& vec) { return Vector3( vec.x_,-vec.y_,-vec.z_); }
 
     Vector<Vector3> rhombicCenters_;
+    Vector<Vector3> faceNormals_;
+    //Directions of the long and short diagonals per face
+    Vector<Vector3> faceAxesU_;
+    Vector<Vector3> faceAxesV_;
+    Vector2 halfDiagonals_;
+    int faceNeighbours_[NUM_SHELL_FACES][SE_LENGTH];
+    void UpdateFaceTables();
+    //Face normals split per axis and padded to a multiple of four
+    PODVector<float> normalX_;
+    PODVector<float> normalY_;
+    PODVector<float> normalZ_;
 
     float radius_;
   /*